@@ -0,0 +1,27 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+// Counts heap allocations made through the global operator new, which
+// AllocationCounter.cpp replaces (new[], nothrow and sized delete all go
+// through it). Each thread counts its own, so a frame or a tick can be
+// checked without the other threads' noise. Over-aligned new and malloc
+// from C libraries (SDL) are not counted.
+//
+// Only targets built with DODGE_COUNT_ALLOCATIONS (and AllocationCounter.cpp)
+// replace operator new: dodge_headless always, Game with the CMake option of
+// the same name. Everywhere else the count stays 0.
+class AllocationCounter {
+public:
+#ifdef DODGE_COUNT_ALLOCATIONS
+    static bool isEnabled() { return true; }
+    // Allocations made by the calling thread since it started.
+    static uint64_t getThreadCount();
+#else
+    static bool isEnabled() { return false; }
+    static uint64_t getThreadCount() { return 0; }
+#endif
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "AssetLoader.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+const unsigned int MIN_WORKERS = 4;
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const char* getKindName(int kind) {
+    static const char* names[] = {"image", "sound", "font"};
+    return names[kind];
+}
+}
+
+AssetLoader::AssetLoader() : nextJob(0), returnedCount(0) {}
+
+AssetLoader::~AssetLoader() {
+    // Unstarted jobs are skipped by pushing the counter past the end.
+    nextJob = static_cast<int>(jobs.size());
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (Job& job : jobs) {
+        if (job.surface) SDL_FreeSurface(job.surface);
+        if (job.sound) Mix_FreeChunk(job.sound);
+        if (job.font) TTF_CloseFont(job.font);
+    }
+}
+
+int AssetLoader::addJob(Kind kind, const std::string& path, int pointSize) {
+    jobs.push_back({kind, path, pointSize, nullptr, nullptr, nullptr, std::string(), 0, 0, 0});
+    return static_cast<int>(jobs.size()) - 1;
+}
+
+int AssetLoader::addImage(const std::string& path) {
+    return addJob(Kind::IMAGE, path, 0);
+}
+
+int AssetLoader::addSound(const std::string& path) {
+    return addJob(Kind::SOUND, path, 0);
+}
+
+int AssetLoader::addFont(const std::string& path, int pointSize) {
+    return addJob(Kind::FONT, path, pointSize);
+}
+
+void AssetLoader::start() {
+    startTime = std::chrono::steady_clock::now();
+    // At least a few workers even on small machines: on a cold disk the jobs
+    // spend much of their time waiting on reads rather than decoding.
+    unsigned int threadCount = std::max(MIN_WORKERS, std::thread::hardware_concurrency());
+    int workerCount = std::min(static_cast<int>(jobs.size()), static_cast<int>(threadCount));
+    completed.reserve(jobs.size());
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+void AssetLoader::workerLoop() {
+    while (true) {
+        int id = nextJob.fetch_add(1);
+        if (id >= static_cast<int>(jobs.size())) {
+            return;
+        }
+        Job& job = jobs[id];
+        job.waitMs = millisecondsSince(startTime);
+        auto decodeStart = std::chrono::steady_clock::now();
+        decode(job);
+        job.decodeMs = millisecondsSince(decodeStart);
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(id);
+        }
+        completedReady.notify_one();
+    }
+}
+
+// SDL_GetError/Mix_GetError/TTF_GetError are thread-local in SDL 2, so each
+// worker reads its own message.
+void AssetLoader::decode(Job& job) {
+    switch (job.kind) {
+        case Kind::IMAGE:
+            job.surface = IMG_Load(job.path.c_str());
+            if (!job.surface) job.error = IMG_GetError();
+            break;
+        case Kind::SOUND:
+            job.sound = Mix_LoadWAV(job.path.c_str());
+            if (!job.sound) job.error = Mix_GetError();
+            break;
+        case Kind::FONT:
+            job.font = TTF_OpenFont(job.path.c_str(), job.pointSize);
+            if (!job.font) job.error = TTF_GetError();
+            break;
+    }
+    if (!job.surface && !job.sound && !job.font && job.error.empty()) {
+        job.error = "the decoder failed without a message";
+    }
+}
+
+int AssetLoader::nextCompleted(bool wait) {
+    std::unique_lock<std::mutex> lock(completedMutex);
+    if (returnedCount == static_cast<int>(jobs.size())) {
+        return -1;
+    }
+    if (wait) {
+        completedReady.wait(lock, [this] { return returnedCount < static_cast<int>(completed.size()); });
+    } else if (returnedCount == static_cast<int>(completed.size())) {
+        return -1;
+    }
+    return completed[returnedCount++];
+}
+
+bool AssetLoader::allCompleted() const {
+    return returnedCount == static_cast<int>(jobs.size());
+}
+
+bool AssetLoader::succeeded(int id) const {
+    const Job& job = jobs[id];
+    return job.surface || job.sound || job.font;
+}
+
+const std::string& AssetLoader::getPath(int id) const {
+    return jobs[id].path;
+}
+
+const std::string& AssetLoader::getError(int id) const {
+    return jobs[id].error;
+}
+
+SDL_Surface* AssetLoader::takeSurface(int id) {
+    SDL_Surface* surface = jobs[id].surface;
+    jobs[id].surface = nullptr;
+    return surface;
+}
+
+Mix_Chunk* AssetLoader::takeSound(int id) {
+    Mix_Chunk* sound = jobs[id].sound;
+    jobs[id].sound = nullptr;
+    return sound;
+}
+
+TTF_Font* AssetLoader::takeFont(int id) {
+    TTF_Font* font = jobs[id].font;
+    jobs[id].font = nullptr;
+    return font;
+}
+
+void AssetLoader::recordUpload(int id, double milliseconds) {
+    jobs[id].uploadMs += milliseconds;
+}
+
+void AssetLoader::printReport() const {
+    std::printf("Asset loading (%d workers):\n", static_cast<int>(workers.size()));
+    std::printf("  %-28s %-6s %9s %9s %9s\n", "asset", "kind", "queue ms", "decode ms", "upload ms");
+    for (const Job& job : jobs) {
+        std::printf("  %-28s %-6s %9.2f %9.2f %9.2f%s\n", job.path.c_str(), getKindName(static_cast<int>(job.kind)),
+                    job.waitMs, job.decodeMs, job.uploadMs, job.error.empty() ? "" : "  FAILED");
+    }
+    std::printf("  total %.2f ms\n", millisecondsSince(startTime));
+    std::fflush(stdout);
+}
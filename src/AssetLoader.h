@@ -0,0 +1,81 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <SDL_ttf.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decodes images to surfaces, loads sound effects and opens fonts on worker
+// threads (music is decoded by AudioSystem).
+// Anything touching the renderer stays on the main thread: it takes finished
+// jobs with nextCompleted(), uploads them and reports the upload time back so
+// the timing report covers both halves.
+class AssetLoader {
+public:
+    AssetLoader();
+    // Joins the workers and frees results nobody took.
+    ~AssetLoader();
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Jobs must be added before start(). Each returns the job id.
+    int addImage(const std::string& path);
+    int addSound(const std::string& path);
+    int addFont(const std::string& path, int pointSize);
+    void start();
+
+    // Id of a job that finished since the last call, or -1 when none is ready
+    // (or, with wait, when every job has already been returned).
+    int nextCompleted(bool wait);
+    bool allCompleted() const;
+
+    // Whether the job produced its asset; ask before taking it.
+    bool succeeded(int id) const;
+    const std::string& getPath(int id) const;
+    const std::string& getError(int id) const;
+    // Ownership passes to the caller.
+    SDL_Surface* takeSurface(int id);
+    Mix_Chunk* takeSound(int id);
+    TTF_Font* takeFont(int id);
+    void recordUpload(int id, double milliseconds);
+
+    // Per-asset queue wait, decode and upload times, plus the wall time since start().
+    void printReport() const;
+
+private:
+    enum class Kind { IMAGE, SOUND, FONT };
+
+    struct Job {
+        Kind kind;
+        std::string path;
+        int pointSize;
+        SDL_Surface* surface;
+        Mix_Chunk* sound;
+        TTF_Font* font;
+        std::string error;
+        double waitMs, decodeMs, uploadMs;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<int> nextJob;
+    std::chrono::steady_clock::time_point startTime;
+
+    std::mutex completedMutex;
+    std::condition_variable completedReady;
+    std::vector<int> completed;
+    int returnedCount;
+
+    int addJob(Kind kind, const std::string& path, int pointSize);
+    void workerLoop();
+    void decode(Job& job);
+};
+
+#endif
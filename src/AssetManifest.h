@@ -0,0 +1,25 @@
+#ifndef ASSET_MANIFEST_H
+#define ASSET_MANIFEST_H
+
+#include "SpriteBatch.h"
+
+// Every asset the game loads, as a source file and as an entry in the pack
+// written by dodge_pack. The game prefers PACK_FILE when it exists.
+struct AssetInfo {
+    const char* name;
+    const char* path;
+};
+
+const char* const PACK_FILE = "assets.pack";
+const AssetInfo BACKGROUND_ASSET = {"background", "assets/background.png"};
+const AssetInfo SPRITE_ASSETS[SPRITE_COUNT] = {
+    {"player", "assets/player.png"},
+    {"obstacle", "assets/obstacle.png"},
+    {"logo", "assets/logo.png"},
+};
+const AssetInfo FONT_ASSET = {"font", "assets/arial.ttf"};
+const int FONT_SIZE = 24;
+const AssetInfo MUSIC_ASSET = {"music", "assets/background_music.mp3"};
+const AssetInfo HIT_SOUND_ASSET = {"hit", "assets/hit.mp3"};
+
+#endif
@@ -0,0 +1,195 @@
+#include "AudioSystem.h"
+#include "Constants.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+uint64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+AudioSystem::AudioSystem()
+    : opened(false), bufferFrames(0), frequency(AUDIO_FREQUENCY), voicePriority(), voiceStart(), stolenCount(0),
+      music(nullptr), musicWanted(false),
+      callbackCount(0), underrunCount(0), mixNanosTotal(0), mixNanosMax(0), mixStart(0), lastCallback(0) {}
+
+AudioSystem::~AudioSystem() {
+    close();
+}
+
+bool AudioSystem::open(int frames) {
+    // SDL wants a power of two.
+    bufferFrames = 1;
+    while (bufferFrames < frames) bufferFrames *= 2;
+    if (Mix_OpenAudio(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, bufferFrames) < 0) {
+        std::cerr << "Failed to initialize SDL_mixer: " << Mix_GetError() << std::endl;
+        return false;
+    }
+    opened = true;
+    Uint16 format = 0;
+    int channels = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    // Channel 0 is the music; effects get the rest and never pick it.
+    Mix_AllocateChannels(VOICE_COUNT + 1);
+    Mix_ReserveChannels(1);
+    Mix_HookMusic(onMixStart, this);
+    Mix_SetPostMix(onMixEnd, this);
+    return true;
+}
+
+void AudioSystem::close() {
+    if (musicThread.joinable()) {
+        musicThread.join();
+    }
+    if (!opened) {
+        return;
+    }
+    Mix_HaltChannel(-1);
+    Mix_HookMusic(nullptr, nullptr);
+    Mix_SetPostMix(nullptr, nullptr);
+    if (music) {
+        Mix_FreeChunk(music);
+        music = nullptr;
+    }
+    Mix_CloseAudio();
+    opened = false;
+}
+
+void AudioSystem::loadMusic(const std::string& path) {
+    startMusicDecode(SDL_RWFromFile(path.c_str(), "rb"));
+}
+
+void AudioSystem::loadMusic(const uint8_t* data, size_t size) {
+    startMusicDecode(SDL_RWFromConstMem(data, static_cast<int>(size)));
+}
+
+void AudioSystem::startMusicDecode(SDL_RWops* source) {
+    if (!source) {
+        std::cerr << "Failed to open music: " << SDL_GetError() << std::endl;
+        return;
+    }
+    // A second load waits for the first; assigning over a joinable thread
+    // would terminate.
+    if (musicThread.joinable()) {
+        musicThread.join();
+    }
+    musicThread = std::thread(&AudioSystem::decodeMusic, this, source);
+}
+
+// A few hundred milliseconds of work for a long track, so it runs while the
+// menu is up. The game goes on without music if it fails.
+void AudioSystem::decodeMusic(SDL_RWops* source) {
+    auto start = std::chrono::steady_clock::now();
+    Mix_Chunk* decoded = Mix_LoadWAV_RW(source, 1);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!decoded) {
+        std::cerr << "Failed to decode music: " << Mix_GetError() << std::endl;
+        return;
+    }
+    std::printf("Music decoded to %.1f MB of PCM in %.1f ms\n", decoded->alen / (1024.0 * 1024.0), ms);
+    std::fflush(stdout);
+    std::lock_guard<std::mutex> lock(musicMutex);
+    if (music) {
+        Mix_HaltChannel(MUSIC_CHANNEL);
+        Mix_FreeChunk(music);
+    }
+    music = decoded;
+    if (musicWanted) {
+        Mix_PlayChannel(MUSIC_CHANNEL, music, -1);
+    }
+}
+
+void AudioSystem::playMusic() {
+    std::lock_guard<std::mutex> lock(musicMutex);
+    musicWanted = true;
+    if (music) {
+        Mix_PlayChannel(MUSIC_CHANNEL, music, -1);
+    }
+}
+
+void AudioSystem::stopMusic() {
+    std::lock_guard<std::mutex> lock(musicMutex);
+    musicWanted = false;
+    if (opened) {
+        Mix_HaltChannel(MUSIC_CHANNEL);
+    }
+}
+
+bool AudioSystem::playSound(Mix_Chunk* sound, SoundPriority priority) {
+    if (!opened || !sound) {
+        return false;
+    }
+    int voice = -1;
+    for (int i = 0; i < VOICE_COUNT && voice < 0; ++i) {
+        if (!Mix_Playing(MUSIC_CHANNEL + 1 + i)) voice = i;
+    }
+    if (voice < 0) {
+        for (int i = 0; i < VOICE_COUNT; ++i) {
+            if (voicePriority[i] > priority) continue;
+            if (voice < 0 || voicePriority[i] < voicePriority[voice] ||
+                (voicePriority[i] == voicePriority[voice] && voiceStart[i] < voiceStart[voice])) {
+                voice = i;
+            }
+        }
+        if (voice < 0) {
+            return false;
+        }
+        ++stolenCount;
+    }
+    int channel = MUSIC_CHANNEL + 1 + voice;
+    Mix_HaltChannel(channel);
+    if (Mix_PlayChannel(channel, sound, 0) < 0) {
+        return false;
+    }
+    voicePriority[voice] = priority;
+    voiceStart[voice] = SDL_GetTicks();
+    return true;
+}
+
+// Runs first in the mixer callback (in place of the music player).
+void AudioSystem::onMixStart(void* userdata, Uint8*, int) {
+    AudioSystem* audio = static_cast<AudioSystem*>(userdata);
+    audio->mixStart = nowNanos();
+}
+
+// Runs last in the mixer callback.
+void AudioSystem::onMixEnd(void* userdata, Uint8*, int) {
+    AudioSystem* audio = static_cast<AudioSystem*>(userdata);
+    uint64_t end = nowNanos();
+    uint64_t mixNanos = end - audio->mixStart;
+    uint64_t periodNanos = static_cast<uint64_t>(audio->bufferFrames) * 1000000000ull / audio->frequency;
+    bool late = audio->lastCallback != 0 && audio->mixStart - audio->lastCallback > periodNanos * 3 / 2;
+    if (late || mixNanos > periodNanos) {
+        audio->underrunCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    audio->lastCallback = audio->mixStart;
+    audio->callbackCount.fetch_add(1, std::memory_order_relaxed);
+    audio->mixNanosTotal.fetch_add(mixNanos, std::memory_order_relaxed);
+    if (mixNanos > audio->mixNanosMax.load(std::memory_order_relaxed)) {
+        audio->mixNanosMax.store(mixNanos, std::memory_order_relaxed);
+    }
+}
+
+AudioStats AudioSystem::getStats() const {
+    AudioStats stats;
+    stats.bufferFrames = bufferFrames;
+    stats.bufferMs = frequency > 0 ? bufferFrames * 1000.0 / frequency : 0;
+    stats.callbacks = callbackCount.load(std::memory_order_relaxed);
+    stats.underruns = underrunCount.load(std::memory_order_relaxed);
+    stats.averageMixMicros = stats.callbacks ? mixNanosTotal.load(std::memory_order_relaxed) / 1000.0 / stats.callbacks : 0;
+    stats.maxMixMicros = mixNanosMax.load(std::memory_order_relaxed) / 1000.0;
+    stats.voicesStolen = stolenCount;
+    return stats;
+}
+
+void AudioSystem::printStats() const {
+    AudioStats stats = getStats();
+    std::printf("Audio: %d frames (%.1f ms), %llu callbacks, %llu underruns, mix avg %.1f us max %.1f us, %llu voices stolen\n",
+                stats.bufferFrames, stats.bufferMs, static_cast<unsigned long long>(stats.callbacks),
+                static_cast<unsigned long long>(stats.underruns), stats.averageMixMicros, stats.maxMixMicros,
+                static_cast<unsigned long long>(stats.voicesStolen));
+    std::fflush(stdout);
+}
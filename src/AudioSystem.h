@@ -0,0 +1,91 @@
+#ifndef AUDIO_SYSTEM_H
+#define AUDIO_SYSTEM_H
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Higher wins when every voice is busy.
+enum SoundPriority { SOUND_PRIORITY_LOW, SOUND_PRIORITY_NORMAL, SOUND_PRIORITY_HIGH };
+
+struct AudioStats {
+    int bufferFrames;
+    double bufferMs;
+    uint64_t callbacks;
+    // Callbacks that came more than 1.5 buffers after the previous one, or
+    // that took longer than a buffer to mix: the device most likely ran dry.
+    uint64_t underruns;
+    double averageMixMicros;
+    double maxMixMicros;
+    uint64_t voicesStolen;
+};
+
+// SDL_mixer output with a small device buffer, a fixed pool of effect voices
+// and music that is decoded to PCM up front instead of streamed. Sound
+// effects are Mix_Chunks, which the mixer already holds as PCM in the device
+// format (converted at load, or baked into the pack). The mix callback is
+// timed through the music hook and post-mix hook, which run first and last
+// in it; the music itself plays as a looping chunk on a reserved channel.
+class AudioSystem {
+public:
+    AudioSystem();
+    ~AudioSystem();
+    // `bufferFrames` samples per channel and callback; 256-512 keeps effects
+    // within about 10 ms at 44.1 kHz, larger values trade latency for CPU.
+    bool open(int bufferFrames);
+    // Stops everything, frees the music and closes the device.
+    void close();
+
+    // Decodes the music on a background thread. The data must stay valid
+    // until close(). playMusic() before it is done starts it once it is.
+    // Loading again waits for the previous decode and replaces its music.
+    void loadMusic(const std::string& path);
+    void loadMusic(const uint8_t* data, size_t size);
+    void playMusic();
+    void stopMusic();
+
+    // Plays on a free voice, else replaces the lowest-priority voice (oldest
+    // first) that is not above `priority`. False if nothing could be replaced.
+    bool playSound(Mix_Chunk* sound, SoundPriority priority);
+
+    AudioStats getStats() const;
+    void printStats() const;
+
+private:
+    static const int VOICE_COUNT = 8;
+    static const int MUSIC_CHANNEL = 0;
+
+    bool opened;
+    int bufferFrames;
+    int frequency;
+    // Game thread only.
+    SoundPriority voicePriority[VOICE_COUNT];
+    uint32_t voiceStart[VOICE_COUNT];
+    uint64_t stolenCount;
+
+    std::thread musicThread;
+    // Guards the decoded music and whether it should be playing, shared with
+    // the decode thread.
+    std::mutex musicMutex;
+    Mix_Chunk* music;
+    bool musicWanted;
+
+    // Written by the audio callback only.
+    std::atomic<uint64_t> callbackCount;
+    std::atomic<uint64_t> underrunCount;
+    std::atomic<uint64_t> mixNanosTotal;
+    std::atomic<uint64_t> mixNanosMax;
+    uint64_t mixStart;
+    uint64_t lastCallback;
+
+    void startMusicDecode(SDL_RWops* source);
+    void decodeMusic(SDL_RWops* source);
+    static void onMixStart(void* userdata, Uint8* stream, int len);
+    static void onMixEnd(void* userdata, Uint8* stream, int len);
+};
+
+#endif
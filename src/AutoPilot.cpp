@@ -0,0 +1,174 @@
+#include "AutoPilot.h"
+#include "Collision.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// How far ahead moves are checked, in steps of SAMPLE_MS. Each sample is one
+// swept test, so nothing slips between them.
+const float HORIZON_MS = 480.0f;
+const float SAMPLE_MS = 40.0f;
+const int SAMPLE_COUNT = static_cast<int>(HORIZON_MS / SAMPLE_MS);
+const float SAMPLE_FRAMES = SAMPLE_MS / SIM_FRAME_MS;
+const float HORIZON_FRAMES = HORIZON_MS / SIM_FRAME_MS;
+// Room kept around the player on top of the exact boxes.
+const float SAFETY_MARGIN = 3.0f;
+// Candidate moves: standing still, then every direction at full and half reach.
+const int DIRECTION_COUNT = 16;
+const int CHOICE_COUNT = 1 + 2 * DIRECTION_COUNT;
+// Tie-breakers between moves that stay clear equally long, in milliseconds:
+// per pixel away from the middle of the screen (obstacles come from the
+// edges), and for keeping the previous move (no jitter).
+const float CENTER_WEIGHT = 0.05f;
+const float KEEP_BONUS = 4.0f;
+
+float directionX(int direction) {
+    return std::cos(direction * 6.2831853f / DIRECTION_COUNT);
+}
+
+float directionY(int direction) {
+    return std::sin(direction * 6.2831853f / DIRECTION_COUNT);
+}
+}
+
+AutoPilot::AutoPilot()
+    : obstacleX(nullptr), obstacleY(nullptr), obstacleDX(nullptr), obstacleDY(nullptr),
+      playerSpeed(PLAYER_SPEED), lastChoice(0) {
+    nearby.reserve(256);
+}
+
+void AutoPilot::reset() {
+    lastChoice = 0;
+}
+
+void AutoPilot::collectNearby(const Simulation& simulation, float reach) {
+    const ObstaclePool& obstacles = simulation.getObstacles();
+    obstacleX = obstacles.getX();
+    obstacleY = obstacles.getY();
+    obstacleDX = obstacles.getDX();
+    obstacleDY = obstacles.getDY();
+
+    float minX = simulation.getPlayerX() - reach - SAFETY_MARGIN;
+    float minY = simulation.getPlayerY() - reach - SAFETY_MARGIN;
+    float maxX = simulation.getPlayerX() + PLAYER_WIDTH + reach + SAFETY_MARGIN;
+    float maxY = simulation.getPlayerY() + PLAYER_HEIGHT + reach + SAFETY_MARGIN;
+    nearby.clear();
+    for (int i = 0; i < obstacles.size(); ++i) {
+        float endX = obstacleX[i] + obstacleDX[i] * HORIZON_FRAMES;
+        float endY = obstacleY[i] + obstacleDY[i] * HORIZON_FRAMES;
+        if (std::max(obstacleX[i], endX) + OBJECT_SIZE > minX && std::min(obstacleX[i], endX) < maxX &&
+            std::max(obstacleY[i], endY) + OBJECT_SIZE > minY && std::min(obstacleY[i], endY) < maxY) {
+            nearby.push_back(i);
+        }
+    }
+}
+
+float AutoPilot::timeToHit(float x, float y, float targetX, float targetY, float& endX, float& endY) const {
+    for (int sample = 0; sample < SAMPLE_COUNT; ++sample) {
+        float fromX = x;
+        float fromY = y;
+        Simulation::walkToward(x, y, targetX, targetY, playerSpeed, SAMPLE_FRAMES);
+        SweptRect player = {fromX - SAFETY_MARGIN, fromY - SAFETY_MARGIN, x - SAFETY_MARGIN, y - SAFETY_MARGIN,
+                            PLAYER_WIDTH + 2 * SAFETY_MARGIN, PLAYER_HEIGHT + 2 * SAFETY_MARGIN};
+        float playerMinX = std::min(player.x0, player.x1);
+        float playerMaxX = std::max(player.x0, player.x1) + player.w;
+        float playerMinY = std::min(player.y0, player.y1);
+        float playerMaxY = std::max(player.y0, player.y1) + player.h;
+        float t0 = sample * SAMPLE_FRAMES;
+        float t1 = t0 + SAMPLE_FRAMES;
+        for (int i : nearby) {
+            SweptRect obstacle = {obstacleX[i] + obstacleDX[i] * t0, obstacleY[i] + obstacleDY[i] * t0,
+                                  obstacleX[i] + obstacleDX[i] * t1, obstacleY[i] + obstacleDY[i] * t1,
+                                  OBJECT_SIZE, OBJECT_SIZE};
+            // Most pairs are nowhere near each other during the sample.
+            if (std::max(obstacle.x0, obstacle.x1) + OBJECT_SIZE <= playerMinX || std::min(obstacle.x0, obstacle.x1) >= playerMaxX ||
+                std::max(obstacle.y0, obstacle.y1) + OBJECT_SIZE <= playerMinY || std::min(obstacle.y0, obstacle.y1) >= playerMaxY) {
+                continue;
+            }
+            float hit = sweptCollisionTime(player, obstacle);
+            if (hit >= 0.0f) {
+                endX = fromX;
+                endY = fromY;
+                return (sample + hit) * SAMPLE_MS;
+            }
+        }
+    }
+    endX = x;
+    endY = y;
+    return HORIZON_MS;
+}
+
+bool AutoPilot::flashLands(float x, float y, float targetX, float targetY, float& landX, float& landY) const {
+    float dx = targetX - x;
+    float dy = targetY - y;
+    float dist = std::sqrt(dx * dx + dy * dy);
+    landX = std::min(std::max(x + (dx / dist) * FLASH_DISTANCE, 0.0f), static_cast<float>(WINDOW_WIDTH - PLAYER_WIDTH));
+    landY = std::min(std::max(y + (dy / dist) * FLASH_DISTANCE, 0.0f), static_cast<float>(WINDOW_HEIGHT - PLAYER_HEIGHT));
+    SweptRect path = {x, y, landX, landY, PLAYER_WIDTH, PLAYER_HEIGHT};
+    for (int i : nearby) {
+        SweptRect obstacle = {obstacleX[i], obstacleY[i], obstacleX[i], obstacleY[i], OBJECT_SIZE, OBJECT_SIZE};
+        if (sweptCollisionTime(path, obstacle) >= 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SimInput AutoPilot::decide(const Simulation& simulation) {
+    float x = simulation.getPlayerX();
+    float y = simulation.getPlayerY();
+    playerSpeed = (simulation.getWeatherSystem().getCurrentWeather() == WeatherEffect::RAIN) ? RAIN_PLAYER_SPEED : PLAYER_SPEED;
+    float reach = playerSpeed * HORIZON_FRAMES;
+    bool flashReady = simulation.getTimeSinceFlash() >= FLASH_COOLDOWN;
+    collectNearby(simulation, flashReady ? reach + FLASH_DISTANCE : reach);
+
+    const float centerX = (WINDOW_WIDTH - PLAYER_WIDTH) / 2.0f;
+    const float centerY = (WINDOW_HEIGHT - PLAYER_HEIGHT) / 2.0f;
+    SimInput best = {x, y, false};
+    float bestTime = -1.0f;
+    float bestValue = -1e9f;
+    int bestChoice = 0;
+    for (int choice = 0; choice < CHOICE_COUNT; ++choice) {
+        float targetX = x;
+        float targetY = y;
+        if (choice > 0) {
+            int direction = (choice - 1) % DIRECTION_COUNT;
+            float distance = (choice <= DIRECTION_COUNT) ? reach : reach / 2;
+            targetX += directionX(direction) * distance;
+            targetY += directionY(direction) * distance;
+        }
+        float endX, endY;
+        float time = timeToHit(x, y, targetX, targetY, endX, endY);
+        float value = time - CENTER_WEIGHT * Simulation::distance(endX, endY, centerX, centerY);
+        if (choice == lastChoice) value += KEEP_BONUS;
+        if (value > bestValue) {
+            bestValue = value;
+            bestTime = time;
+            bestChoice = choice;
+            best.targetX = targetX;
+            best.targetY = targetY;
+        }
+    }
+    lastChoice = bestChoice;
+
+    // Boxed in: jump if some direction lands cleanly and buys more time.
+    // Walking on after the jump continues in the same direction.
+    if (bestTime < HORIZON_MS && flashReady) {
+        float flashTime = bestTime;
+        for (int direction = 0; direction < DIRECTION_COUNT; ++direction) {
+            float targetX = x + directionX(direction) * (FLASH_DISTANCE + reach);
+            float targetY = y + directionY(direction) * (FLASH_DISTANCE + reach);
+            float landX, landY, endX, endY;
+            if (!flashLands(x, y, targetX, targetY, landX, landY)) {
+                continue;
+            }
+            float time = timeToHit(landX, landY, targetX, targetY, endX, endY);
+            if (time > flashTime) {
+                flashTime = time;
+                best = {targetX, targetY, true};
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,42 @@
+#ifndef AUTO_PILOT_H
+#define AUTO_PILOT_H
+
+#include <vector>
+#include "Simulation.h"
+
+// Plays the game on its own: before every step it tries a fixed set of moves
+// (and, when every move runs into something, Flash jumps) against the straight
+// paths of the current obstacles a few hundred milliseconds ahead and keeps
+// the one that stays clear the longest. Obstacles that have not spawned yet are
+// unknown to it. Deterministic, and cheap enough to run every tick.
+class AutoPilot {
+public:
+    AutoPilot();
+    // Forgets the previous choice; call when a new game starts.
+    void reset();
+    // Input for the next step of `simulation`. Targets are player positions
+    // (top-left), like SimInput from the front-end.
+    SimInput decide(const Simulation& simulation);
+
+private:
+    // Obstacles whose path over the horizon comes near anything the player can
+    // reach; rebuilt every call, capacity kept.
+    std::vector<int> nearby;
+    const float* obstacleX;
+    const float* obstacleY;
+    const float* obstacleDX;
+    const float* obstacleDY;
+    float playerSpeed;
+    int lastChoice;
+
+    void collectNearby(const Simulation& simulation, float reach);
+    // Milliseconds until the player, walking from (x, y) towards the target,
+    // first touches a (slightly enlarged) obstacle; the horizon if never.
+    // Sets where the walk ends (or was hit).
+    float timeToHit(float x, float y, float targetX, float targetY, float& endX, float& endY) const;
+    // Whether a Flash from (x, y) towards the target would land cleanly
+    // (obstacles stand still during the jump). Sets the landing spot.
+    bool flashLands(float x, float y, float targetX, float targetY, float& landX, float& landY) const;
+};
+
+#endif
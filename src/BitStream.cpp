@@ -0,0 +1,73 @@
+#include "BitStream.h"
+#include <cstring>
+
+BitWriter::BitWriter(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity), bitPosition(0), failure(false) {
+    std::memset(buffer, 0, capacity);
+}
+
+void BitWriter::writeBits(uint32_t value, int bits) {
+    if (failure || bitPosition + bits > capacity * 8) {
+        failure = true;
+        return;
+    }
+    for (int i = 0; i < bits; ++i) {
+        if (value & (1u << i)) {
+            buffer[bitPosition >> 3] |= static_cast<uint8_t>(1u << (bitPosition & 7));
+        }
+        ++bitPosition;
+    }
+}
+
+void BitWriter::writeBool(bool value) {
+    writeBits(value ? 1 : 0, 1);
+}
+
+void BitWriter::writeSigned(int32_t value, int bits) {
+    uint32_t mask = bits == 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+    writeBits(static_cast<uint32_t>(value) & mask, bits);
+}
+
+bool BitWriter::failed() const {
+    return failure;
+}
+
+size_t BitWriter::getBitCount() const {
+    return bitPosition;
+}
+
+size_t BitWriter::getByteCount() const {
+    return (bitPosition + 7) / 8;
+}
+
+BitReader::BitReader(const uint8_t* data, size_t size) : data(data), size(size), bitPosition(0), failure(false) {}
+
+uint32_t BitReader::readBits(int bits) {
+    if (failure || bitPosition + bits > size * 8) {
+        failure = true;
+        return 0;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < bits; ++i) {
+        if (data[bitPosition >> 3] & (1u << (bitPosition & 7))) {
+            value |= 1u << i;
+        }
+        ++bitPosition;
+    }
+    return value;
+}
+
+bool BitReader::readBool() {
+    return readBits(1) != 0;
+}
+
+int32_t BitReader::readSigned(int bits) {
+    uint32_t value = readBits(bits);
+    if (bits < 32 && (value & (1u << (bits - 1)))) {
+        value |= ~((1u << bits) - 1); // sign-extend
+    }
+    return static_cast<int32_t>(value);
+}
+
+bool BitReader::failed() const {
+    return failure;
+}
@@ -0,0 +1,52 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Packs values of any width up to 32 bits into a caller's buffer, low bits
+// first. Writing past the end sets a sticky failure flag, like SaveReader.
+class BitWriter {
+public:
+    BitWriter(uint8_t* buffer, size_t capacity);
+    void writeBits(uint32_t value, int bits);
+    void writeBool(bool value);
+    // Two's complement in `bits` bits; the value must fit.
+    void writeSigned(int32_t value, int bits);
+
+    bool failed() const;
+    size_t getBitCount() const;
+    // Whole bytes used, the last one padded with zeros.
+    size_t getByteCount() const;
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t bitPosition;
+    bool failure;
+};
+
+// Reads what BitWriter wrote. Reading past the end fails and yields zeros.
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size);
+    uint32_t readBits(int bits);
+    bool readBool();
+    int32_t readSigned(int bits);
+
+    bool failed() const;
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t bitPosition;
+    bool failure;
+};
+
+// Whether `value` fits in a signed field of `bits` bits.
+inline bool fitsSigned(int32_t value, int bits) {
+    int32_t limit = 1 << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+#endif
@@ -0,0 +1,41 @@
+#include "Collision.h"
+#include <algorithm>
+
+namespace {
+// Open interval of t in which [aPos, aPos + aSize) and [bPos + v * t, ... + bSize)
+// overlap on one axis, with b moving at v relative to a.
+bool axisOverlap(float aPos, float aSize, float bPos, float bSize, float v, float& enter, float& exit) {
+    float low = aPos - bSize;
+    float high = aPos + aSize;
+    if (v == 0.0f) {
+        if (bPos <= low || bPos >= high) {
+            return false;
+        }
+        enter = -1.0f;
+        exit = 2.0f;
+        return true;
+    }
+    float t1 = (low - bPos) / v;
+    float t2 = (high - bPos) / v;
+    enter = std::min(t1, t2);
+    exit = std::max(t1, t2);
+    return true;
+}
+}
+
+float sweptCollisionTime(const SweptRect& a, const SweptRect& b) {
+    // Work in a's frame: a stands still and b moves by the difference.
+    float vx = (b.x1 - b.x0) - (a.x1 - a.x0);
+    float vy = (b.y1 - b.y0) - (a.y1 - a.y0);
+    float enterX, exitX, enterY, exitY;
+    if (!axisOverlap(a.x0, a.w, b.x0, b.w, vx, enterX, exitX) ||
+        !axisOverlap(a.y0, a.h, b.y0, b.h, vy, enterY, exitY)) {
+        return -1.0f;
+    }
+    float enter = std::max(enterX, enterY);
+    float exit = std::min(exitX, exitY);
+    if (enter >= exit || enter >= 1.0f || exit <= 0.0f) {
+        return -1.0f;
+    }
+    return std::max(enter, 0.0f);
+}
@@ -0,0 +1,18 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+// An axis-aligned rectangle that moves linearly from (x0, y0) to (x1, y1)
+// during one simulation step.
+struct SweptRect {
+    float x0, y0;
+    float x1, y1;
+    float w, h;
+};
+
+// Fraction of the step (0..1) at which the two rectangles first overlap, or
+// -1 if they never do. Touching edges do not count, as in
+// Simulation::checkCollision. Catches rectangles that pass through each other
+// between the start and end positions.
+float sweptCollisionTime(const SweptRect& a, const SweptRect& b);
+
+#endif
@@ -6,6 +6,7 @@ const int WINDOW_HEIGHT = 600;
 const int PLAYER_WIDTH = 50;
 const int PLAYER_HEIGHT = 50;
 const int OBJECT_SIZE = 30;
+const int MAX_OBSTACLES = 131072;
 const float PLAYER_SPEED = 5.0f;
 const float RAIN_PLAYER_SPEED = PLAYER_SPEED * 0.8f;
 const float INITIAL_OBJECT_SPEED = 3.0f;
@@ -23,5 +24,21 @@ const int CLASSIC_WEATHER_INTERVAL = 30000;
 const int CLASSIC_WEATHER_DURATION = 10000;
 const int SURVIVAL_WEATHER_INTERVAL = 10000;
 const int SURVIVAL_WEATHER_DURATION = 5000;
+const float RAIN_DROPS_PER_SECOND = 6.0f;
+const int RAIN_MAX_DROPS = 1024;
+// Per-frame speeds above (player, obstacles, rain) are tuned for 16 ms frames.
+const float SIM_FRAME_MS = 16.0f;
+// The front-end advances the simulation in fixed ticks of this rate and
+// interpolates rendering between them.
+const int SIM_TICK_RATE = 120;
+const float SIM_TICK_MS = 1000.0f / SIM_TICK_RATE;
+// Longest frame the loop will catch up on, so a stall cannot snowball.
+const float MAX_FRAME_MS = 250.0f;
+// Mixer output; dodge_pack bakes sound effects in this format.
+const int AUDIO_FREQUENCY = 44100;
+const int AUDIO_CHANNELS = 2;
+// Default device buffer in frames (about 11.6 ms); the game's --audio-buffer
+// overrides it.
+const int AUDIO_CHUNK_SIZE = 512;
 
 #endif
@@ -0,0 +1,33 @@
+#include "FrameArena.h"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t capacity)
+    : buffer(new unsigned char[capacity]), capacity(capacity), used(0), peak(0), overflowCount(0) {}
+
+void* FrameArena::allocateBytes(size_t size, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(buffer.get());
+    size_t start = ((base + used + alignment - 1) & ~(alignment - 1)) - base;
+    if (start + size > capacity) {
+        ++overflowCount;
+        return nullptr;
+    }
+    used = start + size;
+    peak = std::max(peak, used);
+    return buffer.get() + start;
+}
+
+void FrameArena::reset() {
+    used = 0;
+}
+
+size_t FrameArena::getCapacity() const {
+    return capacity;
+}
+
+size_t FrameArena::getPeak() const {
+    return peak;
+}
+
+uint64_t FrameArena::getOverflowCount() const {
+    return overflowCount;
+}
@@ -0,0 +1,41 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// Bump allocator for data that lives for one frame. The buffer is allocated
+// once; allocate() only moves an offset and reset() at the start of each
+// frame takes everything back. Objects are not constructed or destroyed, so
+// only trivial types belong here.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity);
+
+    // Uninitialised room for `count` objects, or nullptr (counted as an
+    // overflow) when the frame has used up the arena.
+    template <typename T>
+    T* allocate(int count) {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return static_cast<T*>(allocateBytes(sizeof(T) * count, alignof(T)));
+    }
+    void reset();
+
+    size_t getCapacity() const;
+    // Most bytes used by one frame since construction.
+    size_t getPeak() const;
+    uint64_t getOverflowCount() const;
+
+private:
+    std::unique_ptr<unsigned char[]> buffer;
+    size_t capacity;
+    size_t used;
+    size_t peak;
+    uint64_t overflowCount;
+
+    void* allocateBytes(size_t size, size_t alignment);
+};
+
+#endif
@@ -1,29 +1,66 @@
 #include "Game.h"
+#include "AllocationCounter.h"
+#include "AssetManifest.h"
 #include "Constants.h"
-#include "Utils.h"
-#include <iostream>
+#include "SaveFile.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <random>
+#include <thread>
+
+namespace {
+const char* SAVE_FILE = "savegame.dat";
+// Written by older versions; only read when there is no binary save.
+const char* LEGACY_SAVE_FILE = "savegame.txt";
+// Menu idle time before the attract-mode demo starts.
+const Uint32 DEMO_IDLE_MS = 20000;
+// Rain rects at RAIN_MAX_DROPS take 16 KB; the rest is headroom.
+const size_t FRAME_ARENA_BYTES = 256 * 1024;
+// Ghosts are drawn see-through, and yellow for a moment after a Flash.
+const Uint8 GHOST_ALPHA = 110;
+const double GHOST_FLASH_MS = 200;
+}
 
 Game::Game()
-    : window(nullptr), renderer(nullptr), playerTexture(nullptr), obstacleTexture(nullptr),
-      backgroundTexture(nullptr), logoTexture(nullptr), bgMusic(nullptr), hitSound(nullptr), font(nullptr),
-      playerX(WINDOW_WIDTH / 2.0f - PLAYER_WIDTH / 2.0f),
-      playerY(WINDOW_HEIGHT / 2.0f - PLAYER_HEIGHT / 2.0f),
-      targetX(playerX), targetY(playerY),
-      running(true), lastSpawnTime(0), gameStartTime(0), lastFlashTime(0),
-      score(0), currentObjectSpeed(INITIAL_OBJECT_SPEED),
-      currentSpawnInterval(SPAWN_INTERVAL),
-      state(GameState::MENU), menuSelection(0) {
-    srand(time(nullptr));
+    : window(nullptr), renderer(nullptr), backgroundTexture(nullptr),
+      audioBufferFrames(AUDIO_CHUNK_SIZE), hitSound(nullptr), font(nullptr),
+      titleText(0), menuTexts(), saveHintText(0), demoText(0), weatherTexts(), readyText(0), gameOverText(0), returnHintText(0),
+      targetX(WINDOW_WIDTH / 2.0f - PLAYER_WIDTH / 2.0f),
+      targetY(WINDOW_HEIGHT / 2.0f - PLAYER_HEIGHT / 2.0f),
+      targetMoved(false), lateLatch(false), inputSeq(0), latchedSeq(0),
+      running(true), vsyncEnabled(false), perfFrequency(1), framePeriod(0), frameArena(FRAME_ARENA_BYTES),
+      frameAllocations(0), playingFrames(0), allocatingFrames(0), playingAllocations(0), simAllocations(0), lastSimAllocations(0),
+      state(GameState::MENU), modeInfo(&getModeInfo(GameMode::CLASSIC)), menuSelection(0),
+      scenarioMode(false), scenarioStart(0), lastFrameStart(0), demo(false), lastMenuInput(0),
+      // One hardware thread is left to the render loop.
+      jobs(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1)),
+      simThread(simulation), lastSimPhaseTime(),
+      recording(false), seedFixed(false), fixedSeed(0),
+      backgroundJob(-1), fontJob(-1), soundJob(-1), spriteJobs(), spriteSurfaces() {
+    simulation.setProfiler(&simThread.getProfiler());
+    simulation.setJobSystem(&jobs);
+    pendingMotion.reserve(1024);
 }
 
 Game::~Game() {
-    if (playerTexture) SDL_DestroyTexture(playerTexture);
-    if (obstacleTexture) SDL_DestroyTexture(obstacleTexture);
+    simThread.stop();
+    // Loader results must be freed before the SDL subsystems shut down.
+    assetLoader.reset();
+    for (RenderLayer* layer : {&menuLayer, &gameOverLayer, &playfieldLayer, &scoreHud, &saveHintHud, &timerHud, &weatherHud, &flashHud}) {
+        layer->release();
+    }
+    textRenderer.release();
+    sprites.release();
     if (backgroundTexture) SDL_DestroyTexture(backgroundTexture);
-    if (logoTexture) SDL_DestroyTexture(logoTexture);
-    if (bgMusic) Mix_FreeMusic(bgMusic);
+    // Freed while the device is still open: Mix_FreeChunk halts any voice
+    // still playing the effect, and must run before Mix_CloseAudio.
     if (hitSound) Mix_FreeChunk(hitSound);
+    audio.close();
     if (font) TTF_CloseFont(font);
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
@@ -34,6 +71,10 @@ Game::~Game() {
 }
 
 bool Game::initSDL() {
+    if (scenarioMode && scenario.noWindow) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    }
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         std::cerr << "Failed to initialize SDL: " << SDL_GetError() << std::endl;
         return false;
@@ -42,8 +83,7 @@ bool Game::initSDL() {
         std::cerr << "Failed to initialize SDL_image: " << SDL_GetError() << std::endl;
         return false;
     }
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        std::cerr << "Failed to initialize SDL_mixer: " << Mix_GetError() << std::endl;
+    if (!audio.open(audioBufferFrames)) {
         return false;
     }
     if (TTF_Init() < 0) {
@@ -56,360 +96,967 @@ bool Game::initSDL() {
         std::cerr << "Failed to create window: " << SDL_GetError() << std::endl;
         return false;
     }
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    // Scenarios measure on the software renderer so the numbers do not
+    // depend on (or need) a GPU.
+    Uint32 rendererFlags = scenarioMode ? SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE
+                                        : SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC;
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (!renderer) {
         std::cerr << "Failed to create renderer: " << SDL_GetError() << std::endl;
         return false;
     }
+
+    // Without vsync the loop paces itself to the display refresh rate.
+    SDL_RendererInfo info;
+    vsyncEnabled = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC);
+    SDL_DisplayMode displayMode;
+    int refreshRate = 60;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &displayMode) == 0 && displayMode.refresh_rate > 0) {
+        refreshRate = displayMode.refresh_rate;
+    }
+    perfFrequency = SDL_GetPerformanceFrequency();
+    framePeriod = perfFrequency / refreshRate;
     return true;
 }
 
+void Game::cacheTexts() {
+    titleText = textRenderer.cacheText("Dodge Game");
+    menuTexts[0] = textRenderer.cacheText("Play (Classic)");
+    menuTexts[1] = textRenderer.cacheText("Survival Rush");
+    menuTexts[2] = textRenderer.cacheText("Load Game");
+    menuTexts[3] = textRenderer.cacheText("Exit");
+    saveHintText = textRenderer.cacheText("Press S to save game");
+    demoText = textRenderer.cacheText("Demo - press any key");
+    weatherTexts[0] = textRenderer.cacheText("Weather: Clear");
+    weatherTexts[1] = textRenderer.cacheText("Weather: Rain");
+    weatherTexts[2] = textRenderer.cacheText("Weather: Fog");
+    readyText = textRenderer.cacheText("Ready");
+    gameOverText = textRenderer.cacheText("Game Over!");
+    returnHintText = textRenderer.cacheText("Press Enter to return to menu");
+}
+
+bool Game::initLayers() {
+    if (!SDL_RenderTargetSupported(renderer)) {
+        std::cerr << "Renderer does not support render targets" << std::endl;
+        return false;
+    }
+    int lineHeight = textRenderer.getLineHeight();
+    return menuLayer.init(renderer, WINDOW_WIDTH, WINDOW_HEIGHT, true) &&
+           gameOverLayer.init(renderer, WINDOW_WIDTH, WINDOW_HEIGHT, true) &&
+           playfieldLayer.init(renderer, WINDOW_WIDTH, WINDOW_HEIGHT, true) &&
+           scoreHud.init(renderer, WINDOW_WIDTH, lineHeight, false) &&
+           saveHintHud.init(renderer, WINDOW_WIDTH, lineHeight, false) &&
+           timerHud.init(renderer, WINDOW_WIDTH, lineHeight, false) &&
+           weatherHud.init(renderer, WINDOW_WIDTH, lineHeight, false) &&
+           flashHud.init(renderer, WINDOW_WIDTH, lineHeight, false);
+}
+
+void Game::invalidateLayers() {
+    for (RenderLayer* layer : {&menuLayer, &gameOverLayer, &playfieldLayer, &scoreHud, &saveHintHud, &timerHud, &weatherHud, &flashHud}) {
+        layer->invalidate();
+    }
+}
+
+// Uses the asset pack when there is one. Otherwise queues every source file
+// on the loader and returns once the menu can be drawn (background and
+// font); the rest is picked up by pumpAssets() each frame.
 bool Game::loadAssets() {
-    backgroundTexture = IMG_LoadTexture(renderer, "assets/background.png");
+    if (pack.open(PACK_FILE)) {
+        return loadPackedAssets();
+    }
+    assetLoader.reset(new AssetLoader());
+    backgroundJob = assetLoader->addImage(BACKGROUND_ASSET.path);
+    fontJob = assetLoader->addFont(FONT_ASSET.path, FONT_SIZE);
+    for (int i = 0; i < SPRITE_COUNT; ++i) {
+        spriteJobs[i] = assetLoader->addImage(SPRITE_ASSETS[i].path);
+        spriteSurfaces[i] = nullptr;
+    }
+    soundJob = assetLoader->addSound(HIT_SOUND_ASSET.path);
+    assetLoader->start();
+    audio.loadMusic(MUSIC_ASSET.path);
+
+    while (!backgroundTexture || !font) {
+        int id = assetLoader->nextCompleted(true);
+        if (id < 0 || !processLoadedAsset(id)) {
+            return false;
+        }
+    }
+    return pumpAssets(false);
+}
+
+namespace {
+const PackEntry* findPackEntry(const PackFile& pack, const AssetInfo& asset, PackEntryType type) {
+    const PackEntry* entry = pack.find(asset.name);
+    if (!entry || entry->type != type) {
+        std::cerr << PACK_FILE << " has no " << asset.name << " entry; run dodge_pack again" << std::endl;
+        return nullptr;
+    }
+    return entry;
+}
+
+// A surface over the pack's pixels; nothing is copied until the upload.
+SDL_Surface* wrapPackedPixels(const PackEntry& entry, const uint8_t* pixels) {
+    int width = static_cast<int>(entry.params[0]);
+    int height = static_cast<int>(entry.params[1]);
+    if (pixels + static_cast<size_t>(width) * height * 4 > entry.data + entry.size) {
+        std::cerr << PACK_FILE << " entry " << entry.name << " is truncated" << std::endl;
+        return nullptr;
+    }
+    return SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint8_t*>(pixels), width, height, 32, width * 4,
+                                              SDL_PIXELFORMAT_RGBA32);
+}
+}
+
+// Everything in the pack is already in its final format, so this is only
+// uploads; the sound keeps pointing into the mapped pack and the music is
+// decoded from it in the background.
+bool Game::loadPackedAssets() {
+    Uint64 start = SDL_GetPerformanceCounter();
+    const PackEntry* entry = findPackEntry(pack, BACKGROUND_ASSET, PackEntryType::TEXTURE);
+    SDL_Surface* surface = entry ? wrapPackedPixels(*entry, entry->data) : nullptr;
+    if (!surface) {
+        return false;
+    }
+    backgroundTexture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
     if (!backgroundTexture) {
         std::cerr << "Failed to load background texture: " << SDL_GetError() << std::endl;
         return false;
     }
-    playerTexture = IMG_LoadTexture(renderer, "assets/player.png");
-    if (!playerTexture) {
-        std::cerr << "Failed to load player texture: " << SDL_GetError() << std::endl;
+
+    SDL_Surface* spriteImages[SPRITE_COUNT] = {};
+    bool ok = true;
+    for (int i = 0; i < SPRITE_COUNT && ok; ++i) {
+        entry = findPackEntry(pack, SPRITE_ASSETS[i], PackEntryType::TEXTURE);
+        spriteImages[i] = entry ? wrapPackedPixels(*entry, entry->data) : nullptr;
+        ok = spriteImages[i] != nullptr;
+    }
+    ok = ok && sprites.buildAtlas(renderer, spriteImages, SPRITE_COUNT);
+    for (SDL_Surface* image : spriteImages) {
+        if (image) SDL_FreeSurface(image);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    entry = findPackEntry(pack, FONT_ASSET, PackEntryType::FONT);
+    if (!entry || entry->params[2] != TextRenderer::GLYPH_COUNT) {
         return false;
     }
-    obstacleTexture = IMG_LoadTexture(renderer, "assets/obstacle.png");
-    if (!obstacleTexture) {
-        std::cerr << "Failed to load obstacle texture: " << SDL_GetError() << std::endl;
+    TextRenderer::GlyphMetrics metrics[TextRenderer::GLYPH_COUNT];
+    SaveReader metricsReader(entry->data, entry->size);
+    for (TextRenderer::GlyphMetrics& glyph : metrics) {
+        glyph.x = metricsReader.readI32();
+        glyph.y = metricsReader.readI32();
+        glyph.w = metricsReader.readI32();
+        glyph.h = metricsReader.readI32();
+        glyph.advance = metricsReader.readI32();
+    }
+    surface = metricsReader.failed() ? nullptr : wrapPackedPixels(*entry, entry->data + TextRenderer::GLYPH_COUNT * 5 * 4);
+    ok = surface && textRenderer.init(renderer, surface, metrics);
+    if (surface) SDL_FreeSurface(surface);
+    if (!ok) {
         return false;
     }
-    logoTexture = IMG_LoadTexture(renderer, "assets/logo.png");
-    if (!logoTexture) {
-        std::cerr << "Failed to load logo texture: " << SDL_GetError() << std::endl;
+    cacheTexts();
+    if (!initLayers()) {
         return false;
     }
-    bgMusic = Mix_LoadMUS("assets/background_music.mp3");
-    if (!bgMusic) {
-        std::cerr << "Failed to load background music: " << Mix_GetError() << std::endl;
+
+    entry = findPackEntry(pack, HIT_SOUND_ASSET, PackEntryType::SOUND);
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    if (!entry || entry->params[0] != static_cast<uint32_t>(frequency) || entry->params[1] != format ||
+        entry->params[2] != static_cast<uint32_t>(channels)) {
+        std::cerr << PACK_FILE << " sounds do not match the audio output format; run dodge_pack again" << std::endl;
         return false;
     }
-    hitSound = Mix_LoadWAV("assets/hit.mp3");
+    hitSound = Mix_QuickLoad_RAW(const_cast<Uint8*>(entry->data), entry->size);
+
+    entry = findPackEntry(pack, MUSIC_ASSET, PackEntryType::MUSIC);
+    if (!entry) {
+        return false;
+    }
+    audio.loadMusic(entry->data, entry->size);
     if (!hitSound) {
-        std::cerr << "Failed to load sound effect: " << Mix_GetError() << std::endl;
+        std::cerr << "Failed to load audio from " << PACK_FILE << ": " << Mix_GetError() << std::endl;
         return false;
     }
-    font = TTF_OpenFont("assets/arial.ttf", 24);
-    if (!font) {
-        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
+    std::cout << "Loaded " << pack.getEntries().size() << " assets from " << PACK_FILE << " in "
+              << static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / perfFrequency << " ms" << std::endl;
+    return true;
+}
+
+// Runs on the main thread: everything that needs the renderer happens here.
+bool Game::processLoadedAsset(int id) {
+    if (!assetLoader->succeeded(id)) {
+        std::cerr << "Failed to load " << assetLoader->getPath(id) << ": " << assetLoader->getError(id) << std::endl;
         return false;
     }
+    Uint64 uploadStart = SDL_GetPerformanceCounter();
+    if (id == backgroundJob) {
+        SDL_Surface* surface = assetLoader->takeSurface(id);
+        backgroundTexture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+        if (!backgroundTexture) {
+            std::cerr << "Failed to load background texture: " << SDL_GetError() << std::endl;
+            return false;
+        }
+    } else if (id == fontJob) {
+        font = assetLoader->takeFont(id);
+        if (!textRenderer.init(renderer, font)) {
+            return false;
+        }
+        cacheTexts();
+        if (!initLayers()) {
+            return false;
+        }
+    } else if (id == soundJob) {
+        hitSound = assetLoader->takeSound(id);
+    } else {
+        int sprite = std::find(spriteJobs, spriteJobs + SPRITE_COUNT, id) - spriteJobs;
+        spriteSurfaces[sprite] = assetLoader->takeSurface(id);
+        if (std::find(spriteSurfaces, spriteSurfaces + SPRITE_COUNT, nullptr) != spriteSurfaces + SPRITE_COUNT) {
+            return true;
+        }
+        // The atlas is built once the last sprite has arrived.
+        bool ok = sprites.buildAtlas(renderer, spriteSurfaces, SPRITE_COUNT);
+        for (SDL_Surface*& surface : spriteSurfaces) {
+            SDL_FreeSurface(surface);
+            surface = nullptr;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    assetLoader->recordUpload(id, static_cast<double>(SDL_GetPerformanceCounter() - uploadStart) * 1000.0 / perfFrequency);
+    return true;
+}
+
+// Handles whatever the workers have finished, or with waitForAll blocks until
+// everything is loaded. The loader and its threads go away when it is done.
+bool Game::pumpAssets(bool waitForAll) {
+    if (!assetLoader) {
+        return true;
+    }
+    int id;
+    while ((id = assetLoader->nextCompleted(waitForAll)) >= 0) {
+        if (!processLoadedAsset(id)) {
+            return false;
+        }
+    }
+    if (assetLoader->allCompleted()) {
+        assetLoader->printReport();
+        assetLoader.reset();
+    }
     return true;
 }
 
 bool Game::init() {
-    return initSDL() && loadAssets();
+    if (!initSDL() || !loadAssets()) {
+        return false;
+    }
+    highScore.loadHighScores();
+    return true;
+}
+
+void Game::enableTrace(const std::string& path) {
+    profiler.startTrace(path);
+    // Only collects events; they are merged into this trace when run() ends.
+    simThread.getProfiler().startTrace(path);
+}
+
+void Game::enableRecording(const std::string& path) {
+    recordPath = path;
 }
 
-bool Game::checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2) {
-    return x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2;
+void Game::setSeed(uint64_t seed) {
+    seedFixed = true;
+    fixedSeed = seed;
 }
 
-float Game::distance(float x1, float y1, float x2, float y2) {
-    return sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+void Game::setAudioBufferSize(int frames) {
+    audioBufferFrames = frames;
 }
 
-void Game::movePlayerToTarget() {
-    if (distance(playerX, playerY, targetX, targetY) > 5.0f) {
-        float dx = targetX - playerX;
-        float dy = targetY - playerY;
-        float dist = distance(playerX, playerY, targetX, targetY);
-        float effectiveSpeed = (weatherSystem.getCurrentWeather() == WeatherEffect::RAIN) ? RAIN_PLAYER_SPEED : PLAYER_SPEED;
-        float moveX = (dx / dist) * effectiveSpeed;
-        float moveY = (dy / dist) * effectiveSpeed;
+void Game::setLateLatch(bool enabled) {
+    lateLatch = enabled;
+}
 
-        if (abs(moveX) > abs(dx)) moveX = dx;
-        if (abs(moveY) > abs(dy)) moveY = dy;
+void Game::setScenario(const ScenarioConfig& config) {
+    scenarioMode = true;
+    scenario = config;
+    simulation.setDifficultyOverride(config.spawnInterval, config.objectSpeed);
+    simulation.setRainIntensity(config.rainDropsPerSecond, config.rainMaxDrops);
+    if (config.weatherForced) {
+        simulation.setForcedWeather(config.weather);
+    }
+    // Generous for 240 Hz, so neither side grows its buffers mid-run.
+    size_t frames = static_cast<size_t>(config.seconds * 250) + 1000;
+    scenarioReport.reserve(frames);
+    simThread.recordTickTimes(static_cast<size_t>(config.seconds * SIM_TICK_RATE * 1.1) + 1000);
+}
 
-        playerX += moveX;
-        playerY += moveY;
+bool Game::writeScenarioReport() const {
+    return scenarioReport.write(scenario, simThread.getTickTimes());
+}
 
-        if (playerX < 0) playerX = 0;
-        if (playerX > WINDOW_WIDTH - PLAYER_WIDTH) playerX = WINDOW_WIDTH - PLAYER_WIDTH;
-        if (playerY < 0) playerY = 0;
-        if (playerY > WINDOW_HEIGHT - PLAYER_HEIGHT) playerY = WINDOW_HEIGHT - PLAYER_HEIGHT;
+bool Game::enableGhosts(uint16_t port, const NetAddress& peer) {
+    if (!ghostNet.open(port, peer)) {
+        return false;
     }
+    std::cout << "Ghost race: sending ghost " << static_cast<int>(ghostNet.getGhostId()) << " to "
+              << formatNetAddress(peer) << std::endl;
+    return true;
+}
+
+void Game::setNetConditions(float lossPercent, float latencyMs, float jitterMs) {
+    ghostNet.setConditions(lossPercent, latencyMs, jitterMs);
 }
 
-void Game::saveGameState() {
-    std::ofstream outFile("savegame.txt");
-    if (!outFile) {
-        std::cerr << "Failed to save game state!" << std::endl;
+void Game::startGame(GameMode mode) {
+    if (!pumpAssets(true)) {
+        running = false;
         return;
     }
-    outFile << playerX << " " << playerY << "\n";
-    outFile << (SDL_GetTicks() - gameStartTime) << "\n";
-    outFile << score << "\n";
-    outFile << objects.size() << "\n";
-    for (const auto& obj : objects) {
-        outFile << obj.x << " " << obj.y << " " << obj.dx << " " << obj.dy << "\n";
+    std::random_device device;
+    uint64_t seed = seedFixed ? fixedSeed : (static_cast<uint64_t>(device()) << 32) | device();
+    simulation.seed(seed);
+    simulation.reset(mode);
+    demo = false;
+    recording = !recordPath.empty();
+    if (recording) {
+        inputLog.begin(seed, mode, SIM_TICK_MS);
     }
-    outFile.close();
+    startSimulation();
 }
 
-bool Game::loadGameState() {
-    std::ifstream inFile("savegame.txt");
-    if (!inFile) {
-        std::cerr << "Save game file not found!" << std::endl;
-        return false;
+void Game::startSimulation() {
+    targetX = simulation.getPlayerX();
+    targetY = simulation.getPlayerY();
+    targetMoved = false;
+    // The thread reports 0 until its first command, so numbering restarts;
+    // inputs still waiting belong to the previous game.
+    pendingMotion.clear();
+    latency.discardPending();
+    inputSeq = 0;
+    latchedSeq = 0;
+    lastSimAllocations = 0;
+    ghostSampler.reset();
+    bool piloted = demo || (scenarioMode && scenario.input == ScenarioInput::BOT);
+    simThread.start(recording ? &inputLog : nullptr, piloted ? &autoPilot : nullptr);
+    modeInfo = &getModeInfo(simulation.getMode());
+    state = GameState::PLAYING;
+    audio.playMusic();
+}
+
+// Demo games are not scored or recorded.
+void Game::startDemo() {
+    if (!pumpAssets(true)) {
+        running = false;
+        return;
     }
-    float savedTime;
-    inFile >> playerX >> playerY;
-    inFile >> savedTime;
-    inFile >> score;
-    gameStartTime = SDL_GetTicks() - savedTime;
-    size_t numObjects;
-    inFile >> numObjects;
-    objects.clear();
-    for (size_t i = 0; i < numObjects; ++i) {
-        GameObject obj;
-        inFile >> obj.x >> obj.y >> obj.dx >> obj.dy;
-        obj.texture = obstacleTexture;
-        objects.push_back(obj);
-    }
-    inFile.close();
-    targetX = playerX;
-    targetY = playerY;
-    lastSpawnTime = SDL_GetTicks();
-    return true;
+    std::random_device device;
+    simulation.seed((static_cast<uint64_t>(device()) << 32) | device());
+    simulation.reset(GameMode::CLASSIC);
+    autoPilot.reset();
+    demo = true;
+    recording = false;
+    startSimulation();
 }
 
-void Game::updateScore() {
-    Uint32 currentTime = SDL_GetTicks();
-    score = ((currentTime - gameStartTime) / 1000) * 10; // 1 second = 10 points
+// Scenario games are not scored or recorded either; each one continues the
+// seed sequence so a restart does not replay the game that just ended.
+void Game::startScenarioGame() {
+    if (!pumpAssets(true)) {
+        running = false;
+        return;
+    }
+    simulation.seed(scenario.seed + scenarioReport.getGameCount());
+    simulation.reset(scenario.mode);
+    autoPilot.reset();
+    recording = false;
+    scenarioReport.gameStarted();
+    startSimulation();
+}
+
+void Game::endDemo() {
+    simThread.stop();
+    audio.stopMusic();
+    demo = false;
+    lastMenuInput = SDL_GetTicks();
+    menuLayer.invalidate();
+    state = GameState::MENU;
 }
 
-void Game::updateObjectSpeed() {
-    if (state != GameState::PLAYING_SURVIVAL) {
-        Uint32 currentTime = SDL_GetTicks();
-        Uint32 elapsedTime = currentTime - gameStartTime;
-        currentObjectSpeed = INITIAL_OBJECT_SPEED + (elapsedTime / SPEED_INCREASE_INTERVAL) * SPEED_INCREMENT;
+void Game::updatePlaying(const WorldSnapshot& snapshot) {
+    // The simulation thread exits by itself after publishing the final tick.
+    if (snapshot.status == SimStatus::RUNNING) {
+        return;
+    }
+    if (demo) {
+        endDemo();
+        return;
+    }
+    simThread.stop();
+    if (scenarioMode) {
+        // Keep the load on until the scenario's time is up.
+        startScenarioGame();
+        return;
+    }
+    if (simulation.getStatus() == SimStatus::COLLIDED) {
+        audio.playSound(hitSound, SOUND_PRIORITY_HIGH);
+        audio.stopMusic();
+        std::cout << "Collision detected. Final score: " << simulation.getScore() << std::endl;
+    } else {
+        audio.stopMusic();
+        std::cout << "Survival Rush ended. Final score: " << simulation.getScore() << std::endl;
+    }
+    highScore.submitScore(simulation.getMode(), simulation.getScore(), simulation.getElapsedTime());
+    finishRecording(false);
+    state = GameState::GAME_OVER;
+}
+
+void Game::finishRecording(bool saved) {
+    if (!recording) {
+        return;
+    }
+    recording = false;
+    if (saved) inputLog.recordSave();
+    if (inputLog.save(recordPath)) {
+        std::cout << "Input log written to " << recordPath << " (seed " << inputLog.getSeed() << ")" << std::endl;
     }
 }
 
 void Game::renderMenu() {
-    SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-    SDL_RenderCopy(renderer, backgroundTexture, nullptr, &bgRect);
-
-    renderText(renderer, font, "Dodge Game", 100, textColor);
-    if (menuSelection == 0) {
-        renderText(renderer, font, "High Score (Classic): " + std::to_string(highScore.getHighScoreClassic()), 150, textColor);
-    } else if (menuSelection == 1) {
-        renderText(renderer, font, "High Score (Survival Rush): " + std::to_string(highScore.getHighScoreSurvivalRush()), 150, textColor);
+    // High scores only change while a game runs; the layer is invalidated on
+    // the way back to the menu.
+    if (menuLayer.needsRedraw(menuSelection)) {
+        menuLayer.begin();
+        SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+        SDL_RenderCopy(renderer, backgroundTexture, nullptr, &bgRect);
+
+        textRenderer.renderCached(titleText, 100, textColor);
+        // The first entries start the modes in GameMode order; the rest show
+        // the classic board.
+        GameMode shownMode = (menuSelection < GAME_MODE_COUNT) ? static_cast<GameMode>(menuSelection) : GameMode::CLASSIC;
+        char line[64];
+        snprintf(line, sizeof(line), "High Score (%s): %d", getModeInfo(shownMode).title, highScore.getHighScore(shownMode));
+        textRenderer.renderText(line, 150, textColor);
+        for (int i = 0; i < 4; ++i) {
+            textRenderer.renderCached(menuTexts[i], 250 + i * 50, menuSelection == i ? highlightColor : textColor);
+        }
+        menuLayer.end();
+    }
+    menuLayer.draw(0, 0);
+}
+
+// Draws the snapshot interpolated between its previous and latest tick (or,
+// with late latching, extrapolated to now), then the HUD and overlay.
+void Game::renderPlaying(const WorldSnapshot& snapshot) {
+    {
+        ProfileScope scope(&profiler, PROFILE_RENDER_WORLD);
+        // The logo is part of the background layer, under the obstacles. It
+        // is left out until the atlas exists, and the layer is keyed on that
+        // so it is redrawn once the sprites arrive.
+        if (playfieldLayer.needsRedraw(sprites.isReady())) {
+            playfieldLayer.begin();
+            SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+            SDL_RenderCopy(renderer, backgroundTexture, nullptr, &bgRect);
+            if (sprites.isReady()) {
+                sprites.draw(SPRITE_LOGO, (WINDOW_WIDTH / 2) - 25, WINDOW_HEIGHT - 80, 50, 50);
+                sprites.flush();
+            }
+            playfieldLayer.end();
+        }
+        playfieldLayer.draw(0, 0);
+
+        renderGhosts();
+        double sinceTick = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - snapshot.tickTime).count();
+        if (lateLatch && !demo) {
+            // Late latching: draw the world as of now rather than a tick ago,
+            // with the player already walking toward the newest target. At
+            // most two ticks ahead, in case the simulation stalls.
+            float frames = static_cast<float>(std::min(std::max(sinceTick, 0.0), 2.0 * SIM_TICK_MS) / SIM_FRAME_MS);
+            float speed = (snapshot.weather.getCurrentWeather() == WeatherEffect::RAIN) ? RAIN_PLAYER_SPEED : PLAYER_SPEED;
+            float playerX = snapshot.playerX;
+            float playerY = snapshot.playerY;
+            Simulation::walkToward(playerX, playerY, targetX, targetY, speed, frames);
+            sprites.draw(SPRITE_PLAYER, playerX, playerY, PLAYER_WIDTH, PLAYER_HEIGHT);
+            for (int i = 0; i < snapshot.obstacleCount; ++i) {
+                float x = snapshot.obstacleX[i] + snapshot.obstacleDX[i] * frames;
+                float y = snapshot.obstacleY[i] + snapshot.obstacleDY[i] * frames;
+                sprites.draw(SPRITE_OBSTACLE, x, y, OBJECT_SIZE, OBJECT_SIZE);
+            }
+        } else {
+            // The snapshot is the state at tickTime; draw it as far between the
+            // previous tick and that one as the time since then allows.
+            float alpha = static_cast<float>(std::min(std::max(sinceTick / SIM_TICK_MS, 0.0), 1.0));
+            float playerX = snapshot.previousPlayerX + (snapshot.playerX - snapshot.previousPlayerX) * alpha;
+            float playerY = snapshot.previousPlayerY + (snapshot.playerY - snapshot.previousPlayerY) * alpha;
+            sprites.draw(SPRITE_PLAYER, playerX, playerY, PLAYER_WIDTH, PLAYER_HEIGHT);
+            // Obstacles move linearly, so the previous tick's position is one step
+            // back along their velocity.
+            float stepBack = (1.0f - alpha) * (SIM_TICK_MS / SIM_FRAME_MS);
+            for (int i = 0; i < snapshot.obstacleCount; ++i) {
+                float x = snapshot.obstacleX[i] - snapshot.obstacleDX[i] * stepBack;
+                float y = snapshot.obstacleY[i] - snapshot.obstacleDY[i] * stepBack;
+                sprites.draw(SPRITE_OBSTACLE, x, y, OBJECT_SIZE, OBJECT_SIZE);
+            }
+        }
+        sprites.flush();
+
+        snapshot.weather.renderWeather(renderer, frameArena);
+    }
+    if (ghostNet.isOpen()) {
+        // Each ghost's score over its head, above the weather like the HUD.
+        char label[32];
+        for (int slot = 0; slot < GhostNet::MAX_GHOSTS; ++slot) {
+            const RemoteGhost* ghost = ghostNet.getGhost(slot);
+            if (!ghost) continue;
+            snprintf(label, sizeof(label), ghost->state.status == static_cast<uint8_t>(SimStatus::RUNNING) ? "%d" : "%d out",
+                     ghost->state.score);
+            float x, y;
+            ghostNet.getGhostPosition(*ghost, x, y);
+            textRenderer.renderTextCentered(label, static_cast<int>(x) + PLAYER_WIDTH / 2, static_cast<int>(y) - 30,
+                                            textColor);
+        }
+    }
+
+    // Each HUD line is redrawn only when the value it shows changes (about
+    // once a second); other frames just copy the strips. Values are
+    // formatted into a stack buffer rather than std::strings.
+    ProfileScope scope(&profiler, PROFILE_RENDER_TEXT);
+    char text[32];
+    if (scoreHud.needsRedraw(snapshot.score)) {
+        scoreHud.begin();
+        snprintf(text, sizeof(text), "Score: %d", snapshot.score);
+        textRenderer.renderText(text, 0, textColor);
+        scoreHud.end();
+    }
+    scoreHud.draw(0, 10);
+    if (modeInfo->timeLimit > 0) {
+        int timeLeft = static_cast<int>(modeInfo->timeLimit - snapshot.elapsedTime) / 1000;
+        if (timerHud.needsRedraw(timeLeft)) {
+            timerHud.begin();
+            snprintf(text, sizeof(text), "Time Left: %ds", timeLeft);
+            textRenderer.renderText(text, 0, textColor);
+            timerHud.end();
+        }
+        timerHud.draw(0, 40);
+    } else if (modeInfo->canSave || demo) {
+        if (saveHintHud.needsRedraw(demo)) {
+            saveHintHud.begin();
+            textRenderer.renderCached(demo ? demoText : saveHintText, 0, demo ? highlightColor : textColor);
+            saveHintHud.end();
+        }
+        saveHintHud.draw(0, 40);
+    }
+
+    int weather = static_cast<int>(snapshot.weather.getCurrentWeather());
+    if (weatherHud.needsRedraw(weather)) {
+        weatherHud.begin();
+        textRenderer.renderCached(weatherTexts[weather], 0, textColor);
+        weatherHud.end();
+    }
+    weatherHud.draw(0, 70);
+
+    // Seconds of cooldown left, or -1 while "Ready" shows.
+    double timeSinceLastFlash = snapshot.timeSinceFlash;
+    if (timeSinceLastFlash < FLASH_COOLDOWN + READY_DISPLAY_TIME) {
+        int cooldown = -1;
+        if (timeSinceLastFlash < FLASH_COOLDOWN) {
+            cooldown = static_cast<int>(FLASH_COOLDOWN - timeSinceLastFlash) / 1000;
+        }
+        if (flashHud.needsRedraw(cooldown)) {
+            flashHud.begin();
+            if (cooldown >= 0) {
+                snprintf(text, sizeof(text), "%ds", cooldown);
+                textRenderer.renderTextCentered(text, WINDOW_WIDTH / 2, 0, textColor);
+            } else {
+                textRenderer.renderCachedCentered(readyText, WINDOW_WIDTH / 2, 0, textColor);
+            }
+            flashHud.end();
+        }
+        flashHud.draw(0, WINDOW_HEIGHT - 110);
+    }
+
+    if (profiler.isEnabled()) {
+        renderProfilerOverlay();
+    }
+}
+
+// Queued before the player so the player stays on top.
+void Game::renderGhosts() {
+    if (!ghostNet.isOpen()) {
+        return;
+    }
+    double now = ghostNet.getTimeMs();
+    for (int slot = 0; slot < GhostNet::MAX_GHOSTS; ++slot) {
+        const RemoteGhost* ghost = ghostNet.getGhost(slot);
+        if (!ghost) continue;
+        bool flashing = ghost->lastFlashMs >= 0 && now - ghost->lastFlashMs < GHOST_FLASH_MS;
+        SDL_Color tint = flashing ? SDL_Color{255, 255, 0, GHOST_ALPHA} : SDL_Color{255, 255, 255, GHOST_ALPHA};
+        float x, y;
+        ghostNet.getGhostPosition(*ghost, x, y);
+        sprites.draw(SPRITE_PLAYER, x, y, PLAYER_WIDTH, PLAYER_HEIGHT, tint, 0);
+    }
+}
+
+void Game::renderProfilerOverlay() {
+    SDL_Rect panel = {0, 100, 520, 30 * (PROFILE_PHASE_COUNT + 7) + 10};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+    SDL_RenderFillRect(renderer, &panel);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    char line[128];
+    int y = panel.y + 5;
+    ProfileStats frame = profiler.getFrameStats();
+    snprintf(line, sizeof(line), "Frame p50 %.2f p95 %.2f p99 %.2f max %.2f", frame.p50, frame.p95, frame.p99, frame.max);
+    textRenderer.renderTextAt(line, 10, y, highlightColor);
+    y += 30;
+    snprintf(line, sizeof(line), "Obstacles: %d  (ms: avg / p99 / max)", profiler.getObstacleCount());
+    textRenderer.renderTextAt(line, 10, y, highlightColor);
+    for (int p = 0; p < PROFILE_PHASE_COUNT; ++p) {
+        ProfilePhase phase = static_cast<ProfilePhase>(p);
+        ProfileStats stats = profiler.getPhaseStats(phase);
+        y += 30;
+        snprintf(line, sizeof(line), "%-13s %6.3f %6.3f %6.3f", Profiler::getPhaseName(phase), stats.average, stats.p99, stats.max);
+        textRenderer.renderTextAt(line, 10, y, textColor);
+    }
+    JobStats jobStats = jobs.getStats();
+    y += 30;
+    snprintf(line, sizeof(line), "Jobs: %d threads %3.0f%% busy, %llu stolen", jobStats.threadCount,
+             jobStats.utilisation * 100.0, static_cast<unsigned long long>(jobStats.stolenChunks));
+    textRenderer.renderTextAt(line, 10, y, highlightColor);
+    AudioStats audioStats = audio.getStats();
+    y += 30;
+    snprintf(line, sizeof(line), "Audio: %.1f ms buffer, mix %.0f/%.0f us, %llu underruns", audioStats.bufferMs,
+             audioStats.averageMixMicros, audioStats.maxMixMicros, static_cast<unsigned long long>(audioStats.underruns));
+    textRenderer.renderTextAt(line, 10, y, highlightColor);
+    y += 30;
+    snprintf(line, sizeof(line), "Input: p50 %.1f p99 %.1f ms, late latch %s (F4)", latency.getPercentile(50),
+             latency.getPercentile(99), lateLatch ? "on" : "off");
+    textRenderer.renderTextAt(line, 10, y, highlightColor);
+    y += 30;
+    if (AllocationCounter::isEnabled()) {
+        snprintf(line, sizeof(line), "Allocs: %llu last frame, %llu/%llu frames, sim %llu",
+                 static_cast<unsigned long long>(frameAllocations), static_cast<unsigned long long>(allocatingFrames),
+                 static_cast<unsigned long long>(playingFrames), static_cast<unsigned long long>(simAllocations));
+    } else {
+        snprintf(line, sizeof(line), "Allocs: not counted (DODGE_COUNT_ALLOCATIONS)");
+    }
+    textRenderer.renderTextAt(line, 10, y, highlightColor);
+    GhostNetStats net = ghostNet.getStats();
+    int ghostCount = 0;
+    for (int slot = 0; slot < GhostNet::MAX_GHOSTS; ++slot) {
+        if (ghostNet.getGhost(slot)) ++ghostCount;
+    }
+    y += 30;
+    if (ghostNet.isOpen()) {
+        snprintf(line, sizeof(line), "Ghosts: %d, up %.0f B/s, down %.0f B/s, %llu dropped", ghostCount,
+                 net.sendBytesPerSecond, net.receiveBytesPerSecond, static_cast<unsigned long long>(net.packetsDropped));
     } else {
-        renderText(renderer, font, "High Score (Classic): " + std::to_string(highScore.getHighScoreClassic()), 150, textColor);
+        snprintf(line, sizeof(line), "Ghosts: off");
+    }
+    textRenderer.renderTextAt(line, 10, y, highlightColor);
+}
+
+void Game::renderGameOver() {
+    if (gameOverLayer.needsRedraw(simulation.getScore())) {
+        gameOverLayer.begin();
+        SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+        SDL_RenderCopy(renderer, backgroundTexture, nullptr, &bgRect);
+
+        textRenderer.renderCached(gameOverText, (WINDOW_HEIGHT / 2) - 50, textColor);
+        char text[32];
+        snprintf(text, sizeof(text), "Score: %d", simulation.getScore());
+        textRenderer.renderText(text, WINDOW_HEIGHT / 2, textColor);
+        textRenderer.renderCached(returnHintText, (WINDOW_HEIGHT / 2) + 50, textColor);
+        gameOverLayer.end();
     }
-    renderText(renderer, font, "Play (Classic)", 250, menuSelection == 0 ? highlightColor : textColor);
-    renderText(renderer, font, "Survival Rush", 300, menuSelection == 1 ? highlightColor : textColor);
-    renderText(renderer, font, "Load Game", 350, menuSelection == 2 ? highlightColor : textColor);
-    renderText(renderer, font, "Exit", 400, menuSelection == 3 ? highlightColor : textColor);
+    gameOverLayer.draw(0, 0);
+}
 
-    SDL_RenderPresent(renderer);
+void Game::waitForNextFrame(Uint64 frameStart) {
+    // Sleep while more than ~2 ms remain (SDL_Delay can oversleep by about a
+    // millisecond), then spin for the rest.
+    Uint64 deadline = frameStart + framePeriod;
+    Uint64 spinMargin = perfFrequency / 500;
+    Uint64 now = SDL_GetPerformanceCounter();
+    while (now + spinMargin < deadline) {
+        SDL_Delay(static_cast<Uint32>((deadline - now - spinMargin) * 1000 / perfFrequency));
+        now = SDL_GetPerformanceCounter();
+    }
+    while (now < deadline) {
+        now = SDL_GetPerformanceCounter();
+    }
 }
 
-void Game::run() {
-    while (running) {
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = false;
-            } else if (state == GameState::MENU) {
-                if (event.type == SDL_KEYDOWN) {
-                    if (event.key.keysym.sym == SDLK_UP) {
-                        menuSelection = (menuSelection - 1 + 4) % 4;
-                    } else if (event.key.keysym.sym == SDLK_DOWN) {
-                        menuSelection = (menuSelection + 1) % 4;
-                    } else if (event.key.keysym.sym == SDLK_RETURN) {
-                        if (menuSelection == 0) {
-                            state = GameState::PLAYING;
-                            gameStartTime = SDL_GetTicks();
-                            score = 0;
-                            objects.clear();
-                            currentObjectSpeed = INITIAL_OBJECT_SPEED;
-                            currentSpawnInterval = SPAWN_INTERVAL;
-                            lastFlashTime = gameStartTime - FLASH_COOLDOWN - 1;
-                            Mix_PlayMusic(bgMusic, -1);
-                        } else if (menuSelection == 1) {
-                            state = GameState::PLAYING_SURVIVAL;
-                            gameStartTime = SDL_GetTicks();
-                            score = 0;
-                            objects.clear();
-                            currentObjectSpeed = INITIAL_OBJECT_SPEED;
-                            currentSpawnInterval = SPAWN_INTERVAL_SURVIVAL;
-                            lastFlashTime = gameStartTime - FLASH_COOLDOWN - 1;
-                            Mix_PlayMusic(bgMusic, -1);
-                        } else if (menuSelection == 2) {
-                            if (loadGameState()) {
-                                state = GameState::PLAYING;
-                                Mix_PlayMusic(bgMusic, -1);
-                            }
-                        } else if (menuSelection == 3) {
+void Game::handleEvents() {
+    ProfileScope scope(&profiler, PROFILE_EVENTS);
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            running = false;
+        } else if (event.type == SDL_RENDER_TARGETS_RESET) {
+            // The driver dropped the contents of every target texture.
+            invalidateLayers();
+        } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) {
+            profiler.setEnabled(!profiler.isEnabled());
+        } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F4) {
+            // Each mode keeps its own histogram, printed when it is left.
+            printLatency();
+            latency.reset();
+            lateLatch = !lateLatch;
+        } else if (state == GameState::MENU) {
+            if (event.type == SDL_KEYDOWN || event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN) {
+                lastMenuInput = SDL_GetTicks();
+            }
+            if (event.type == SDL_KEYDOWN) {
+                if (event.key.keysym.sym == SDLK_UP) {
+                    menuSelection = (menuSelection - 1 + 4) % 4;
+                } else if (event.key.keysym.sym == SDLK_DOWN) {
+                    menuSelection = (menuSelection + 1) % 4;
+                } else if (event.key.keysym.sym == SDLK_RETURN) {
+                    if (menuSelection == 0) {
+                        startGame(GameMode::CLASSIC);
+                    } else if (menuSelection == 1) {
+                        startGame(GameMode::SURVIVAL_RUSH);
+                    } else if (menuSelection == 2) {
+                        if (!pumpAssets(true)) {
                             running = false;
+                            return;
                         }
-                    }
-                }
-            } else if (state == GameState::PLAYING || state == GameState::PLAYING_SURVIVAL) {
-                if (event.type == SDL_MOUSEMOTION) {
-                    targetX = event.motion.x - PLAYER_WIDTH / 2.0f;
-                    targetY = event.motion.y - PLAYER_HEIGHT / 2.0f;
-                } else if (event.type == SDL_KEYDOWN) {
-                    if (event.key.keysym.sym == SDLK_f) {
-                        Uint32 currentTime = SDL_GetTicks();
-                        if (currentTime - lastFlashTime >= FLASH_COOLDOWN) {
-                            float dx = targetX - playerX;
-                            float dy = targetY - playerY;
-                            float dist = distance(playerX, playerY, targetX, targetY);
-                            if (dist > 0) {
-                                float moveX = (dx / dist) * FLASH_DISTANCE;
-                                float moveY = (dy / dist) * FLASH_DISTANCE;
-                                playerX += moveX;
-                                playerY += moveY;
-
-                                if (playerX < 0) playerX = 0;
-                                if (playerX > WINDOW_WIDTH - PLAYER_WIDTH) playerX = WINDOW_WIDTH - PLAYER_WIDTH;
-                                if (playerY < 0) playerY = 0;
-                                if (playerY > WINDOW_HEIGHT - PLAYER_HEIGHT) playerY = WINDOW_HEIGHT - PLAYER_HEIGHT;
-
-                                lastFlashTime = currentTime;
-                            }
-                        }
-                    } else if (event.key.keysym.sym == SDLK_s) {
-                        if (state == GameState::PLAYING) {
-                            saveGameState();
-                            Mix_HaltMusic();
-                            state = GameState::MENU;
+                        const char* savePath = std::ifstream(SAVE_FILE) ? SAVE_FILE : LEGACY_SAVE_FILE;
+                        if (simulation.loadState(savePath)) {
+                            recording = false;
+                            startSimulation();
                         }
+                    } else if (menuSelection == 3) {
+                        running = false;
                     }
                 }
-            } else if (state == GameState::GAME_OVER) {
-                if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RETURN) {
-                    state = GameState::MENU;
-                }
             }
-        }
-
-        if (state == GameState::MENU) {
-            renderMenu();
-        } else if (state == GameState::PLAYING || state == GameState::PLAYING_SURVIVAL) {
-            movePlayerToTarget();
-            weatherSystem.updateWeather(SDL_GetTicks(), state == GameState::PLAYING);
-
-            Uint32 currentTime = SDL_GetTicks();
-            if (state == GameState::PLAYING) {
-                Uint32 elapsedTime = currentTime - gameStartTime;
-                if (elapsedTime / 30000 > 0) {
-                    int decreaseCount = elapsedTime / 30000;
-                    currentSpawnInterval = std::max(SPAWN_INTERVAL - (decreaseCount * SPAWN_INTERVAL_DECREASE_RATE), SPAWN_INTERVAL_MIN);
-                }
+        } else if (demo) {
+            if (event.type == SDL_KEYDOWN || event.type == SDL_MOUSEBUTTONDOWN) {
+                endDemo();
             }
-
-            if (state == GameState::PLAYING_SURVIVAL) {
-                Uint32 elapsedTime = currentTime - gameStartTime;
-                if (elapsedTime >= SURVIVAL_RUSH_DURATION) {
-                    Mix_HaltMusic();
-                    updateScore();
-                    std::cout << "Survival Rush ended. Final score: " << score << std::endl;
-                    highScore.updateHighScoreSurvivalRush(score);
-                    state = GameState::GAME_OVER;
-                    continue;
+        } else if (state == GameState::PLAYING) {
+            if (event.type == SDL_MOUSEMOTION) {
+                targetX = event.motion.x - PLAYER_WIDTH / 2.0f;
+                targetY = event.motion.y - PLAYER_HEIGHT / 2.0f;
+                targetMoved = true;
+                pendingMotion.push_back(eventTime(event));
+            } else if (event.type == SDL_KEYDOWN) {
+                if (event.key.keysym.sym == SDLK_f) {
+                    if (simThread.pushInput({SimCommand::FLASH, 0, 0, inputSeq + 1})) {
+                        latency.inputSent(++inputSeq, eventTime(event), false);
+                    }
+                } else if (event.key.keysym.sym == SDLK_s) {
+                    if (modeInfo->canSave) {
+                        simThread.stop();
+                        simulation.saveState(SAVE_FILE);
+                        finishRecording(true);
+                        audio.stopMusic();
+                        menuLayer.invalidate();
+                        lastMenuInput = SDL_GetTicks();
+                        state = GameState::MENU;
+                    }
                 }
             }
-
-            if (currentTime - lastSpawnTime > currentSpawnInterval) {
-                updateObjectSpeed();
-                objects.push_back(spawnObject(obstacleTexture, currentObjectSpeed));
-                lastSpawnTime = currentTime;
+        } else if (state == GameState::GAME_OVER) {
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RETURN) {
+                menuLayer.invalidate();
+                lastMenuInput = SDL_GetTicks();
+                state = GameState::MENU;
             }
+        }
+    }
+    sendTarget();
+}
 
-            for (auto it = objects.begin(); it != objects.end();) {
-                it->x += it->dx;
-                it->y += it->dy;
-
-                if (it->x < -OBJECT_SIZE || it->x > WINDOW_WIDTH ||
-                    it->y < -OBJECT_SIZE || it->y > WINDOW_HEIGHT) {
-                    it = objects.erase(it);
-                    continue;
-                }
+// SDL stamps events in SDL_GetTicks() milliseconds.
+InputLatency::Clock::time_point Game::eventTime(const SDL_Event& event) const {
+    Uint32 age = SDL_GetTicks() - event.common.timestamp;
+    return InputLatency::Clock::now() - std::chrono::milliseconds(age);
+}
 
-                if (checkCollision(playerX, playerY, PLAYER_WIDTH, PLAYER_HEIGHT,
-                                   it->x, it->y, OBJECT_SIZE, OBJECT_SIZE)) {
-                    Mix_PlayChannel(-1, hitSound, 0);
-                    Mix_HaltMusic();
-                    updateScore();
-                    std::cout << "Collision detected. Final score: " << score << std::endl;
-                    if (state == GameState::PLAYING) {
-                        highScore.updateHighScoreClassic(score);
-                    } else {
-                        highScore.updateHighScoreSurvivalRush(score);
-                    }
-                    state = GameState::GAME_OVER;
-                }
-                ++it;
-            }
+// One target per batch of motion events; a full queue retries next frame.
+void Game::sendTarget() {
+    if (!targetMoved || !simThread.isRunning()) {
+        return;
+    }
+    if (!simThread.pushInput({SimCommand::TARGET, targetX, targetY, inputSeq + 1})) {
+        return;
+    }
+    ++inputSeq;
+    // Late-latched targets are drawn before the simulation gets to them.
+    bool predicted = lateLatch && !demo;
+    for (const InputLatency::Clock::time_point& time : pendingMotion) {
+        latency.inputSent(inputSeq, time, predicted);
+    }
+    pendingMotion.clear();
+    targetMoved = false;
+    if (predicted) {
+        latchedSeq = inputSeq;
+    }
+}
 
-            updateScore();
+// Takes the motion that arrived while the frame was simulated and prepared,
+// just before the world is drawn. Only motion is taken off the queue; keys
+// and buttons wait for the next handleEvents().
+void Game::latchInput() {
+    SDL_PumpEvents();
+    SDL_Event events[64];
+    int count;
+    while ((count = SDL_PeepEvents(events, 64, SDL_GETEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION)) > 0) {
+        for (int i = 0; i < count; ++i) {
+            pendingMotion.push_back(eventTime(events[i]));
+        }
+        targetX = events[count - 1].motion.x - PLAYER_WIDTH / 2.0f;
+        targetY = events[count - 1].motion.y - PLAYER_HEIGHT / 2.0f;
+        targetMoved = true;
+    }
+    sendTarget();
+}
 
-            SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-            SDL_RenderCopy(renderer, backgroundTexture, nullptr, &bgRect);
+void Game::printLatency() const {
+    latency.printReport(lateLatch ? "late-latched" : "normal");
+}
 
-            SDL_Rect playerRect = {(int)playerX, (int)playerY, PLAYER_WIDTH, PLAYER_HEIGHT};
-            SDL_RenderCopy(renderer, playerTexture, nullptr, &playerRect);
+void Game::printAllocations() const {
+    if (AllocationCounter::isEnabled()) {
+        std::printf("Heap allocations while playing: %llu in %llu of %llu frames, simulation thread %llu\n",
+                    static_cast<unsigned long long>(playingAllocations), static_cast<unsigned long long>(allocatingFrames),
+                    static_cast<unsigned long long>(playingFrames), static_cast<unsigned long long>(simAllocations));
+    }
+    std::printf("Frame arena: peak %zu of %zu bytes, %llu overflows\n", frameArena.getPeak(), frameArena.getCapacity(),
+                static_cast<unsigned long long>(frameArena.getOverflowCount()));
+    std::fflush(stdout);
+}
 
-            for (const auto& obj : objects) {
-                SDL_Rect objRect = {(int)obj.x, (int)obj.y, OBJECT_SIZE, OBJECT_SIZE};
-                SDL_RenderCopy(renderer, obj.texture, nullptr, &objRect);
-            }
+// Sends the local player (its final state while the game over screen is up)
+// and takes in the other players. Demo games are not raced.
+void Game::updateGhosts(const WorldSnapshot* snapshot) {
+    if (!ghostNet.isOpen()) {
+        return;
+    }
+    ghostNet.update();
+    if (demo) {
+        return;
+    }
+    if (snapshot) {
+        ghostNet.publish(ghostSampler.sample(static_cast<uint32_t>(snapshot->elapsedTime / SIM_TICK_MS), snapshot->playerX,
+                                             snapshot->playerY, snapshot->timeSinceFlash, snapshot->status, snapshot->score));
+    } else if (state == GameState::GAME_OVER) {
+        ghostNet.publish(ghostSampler.sample(static_cast<uint32_t>(simulation.getElapsedTime() / SIM_TICK_MS),
+                                             simulation.getPlayerX(), simulation.getPlayerY(),
+                                             simulation.getTimeSinceFlash(), simulation.getStatus(), simulation.getScore()));
+    }
+}
 
-            weatherSystem.renderWeather(renderer);
+void Game::run() {
+    if (scenarioMode) {
+        startScenarioGame();
+        scenarioStart = SDL_GetTicks();
+    }
+    while (running) {
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        uint64_t allocationsBefore = AllocationCounter::getThreadCount();
+        frameArena.reset();
 
-            renderText(renderer, font, "Score: " + std::to_string(score), 10, textColor);
-            if (state == GameState::PLAYING) {
-                renderText(renderer, font, "Press S to save game", 40, textColor);
-            } else if (state == GameState::PLAYING_SURVIVAL) {
-                int timeLeft = (SURVIVAL_RUSH_DURATION - (currentTime - gameStartTime)) / 1000;
-                renderText(renderer, font, "Time Left: " + std::to_string(timeLeft) + "s", 40, textColor);
-            }
+        if (!pumpAssets(false)) {
+            break;
+        }
+        handleEvents();
+        if (scenarioMode && scenario.input == ScenarioInput::SWEEP && state == GameState::PLAYING) {
+            // A fixed figure-eight over most of the playfield, one loop every
+            // 8 s, sent the same way as mouse motion.
+            double t = SDL_GetTicks() * (2.0 * 3.14159265 / 8000.0);
+            targetX = static_cast<float>((WINDOW_WIDTH - PLAYER_WIDTH) * (0.5 + 0.4 * std::sin(t)));
+            targetY = static_cast<float>((WINDOW_HEIGHT - PLAYER_HEIGHT) * (0.5 + 0.4 * std::sin(2 * t)));
+            targetMoved = true;
+            sendTarget();
+        }
 
-            std::string weatherText = "Weather: ";
-            if (weatherSystem.getCurrentWeather() == WeatherEffect::RAIN) {
-                weatherText += "Rain";
-            } else if (weatherSystem.getCurrentWeather() == WeatherEffect::FOG) {
-                weatherText += "Fog";
-            } else {
-                weatherText += "Clear";
+        int obstacleCount = 0;
+        int rainDropCount = 0;
+        // Last simulation command reflected in the frame, if it shows the game.
+        uint32_t shownSeq = 0;
+        bool shownPlaying = false;
+        if (state == GameState::PLAYING) {
+            const WorldSnapshot& snapshot = simThread.acquireSnapshot();
+            // Fold in the simulation time spent since the last frame so the
+            // overlay still shows the per-phase cost of the ticks.
+            for (int p = 0; p < PROFILE_PHASE_COUNT; ++p) {
+                profiler.addTime(static_cast<ProfilePhase>(p), snapshot.phaseTime[p] - lastSimPhaseTime[p]);
+                lastSimPhaseTime[p] = snapshot.phaseTime[p];
             }
-            renderText(renderer, font, weatherText, 70, textColor);
-
-            SDL_Rect logoRect = {(WINDOW_WIDTH / 2) - 25, WINDOW_HEIGHT - 80, 50, 50};
-            SDL_RenderCopy(renderer, logoTexture, nullptr, &logoRect);
-
-            Uint32 timeSinceLastFlash = currentTime - lastFlashTime;
-            if (timeSinceLastFlash < FLASH_COOLDOWN) {
-                int cooldownTimeRemaining = (FLASH_COOLDOWN - timeSinceLastFlash) / 1000;
-                std::string cooldownText = std::to_string(cooldownTimeRemaining) + "s";
-                renderTextCentered(renderer, font, cooldownText, WINDOW_WIDTH / 2, WINDOW_HEIGHT - 110, textColor);
-            } else if (timeSinceLastFlash < FLASH_COOLDOWN + READY_DISPLAY_TIME) {
-                renderTextCentered(renderer, font, "Ready", WINDOW_WIDTH / 2, WINDOW_HEIGHT - 110, textColor);
+            obstacleCount = snapshot.obstacleCount;
+            rainDropCount = snapshot.weather.getRainDropCount();
+            simAllocations += snapshot.allocations - lastSimAllocations;
+            lastSimAllocations = snapshot.allocations;
+            updateGhosts(&snapshot);
+            updatePlaying(snapshot);
+            if (state != GameState::GAME_OVER) {
+                if (lateLatch && !demo) {
+                    latchInput();
+                }
+                renderPlaying(snapshot);
+                shownSeq = snapshot.inputSeq;
+                shownPlaying = true;
             }
+        } else {
+            updateGhosts(nullptr);
+        }
 
-            SDL_RenderPresent(renderer);
+        if (state == GameState::MENU && SDL_GetTicks() - lastMenuInput > DEMO_IDLE_MS) {
+            startDemo();
+        }
+        if (state == GameState::MENU) {
+            renderMenu();
         } else if (state == GameState::GAME_OVER) {
-            SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-            SDL_RenderCopy(renderer, backgroundTexture, nullptr, &bgRect);
-
-            renderText(renderer, font, "Game Over!", (WINDOW_HEIGHT / 2) - 50, textColor);
-            renderText(renderer, font, "Score: " + std::to_string(score), WINDOW_HEIGHT / 2, textColor);
-            renderText(renderer, font, "Press Enter to return to menu", (WINDOW_HEIGHT / 2) + 50, textColor);
-
+            renderGameOver();
+        }
+        {
+            ProfileScope scope(&profiler, PROFILE_PRESENT);
             SDL_RenderPresent(renderer);
         }
+        if (shownPlaying) {
+            latency.framePresented(shownSeq, latchedSeq, InputLatency::Clock::now());
+            frameAllocations = AllocationCounter::getThreadCount() - allocationsBefore;
+            playingAllocations += frameAllocations;
+            ++playingFrames;
+            if (frameAllocations > 0) ++allocatingFrames;
+            if (scenarioMode) {
+                Uint64 frameEnd = SDL_GetPerformanceCounter();
+                double interval = lastFrameStart ? (frameStart - lastFrameStart) * 1000.0 / perfFrequency : 0;
+                scenarioReport.addFrame((frameEnd - frameStart) * 1000.0 / perfFrequency, interval, obstacleCount, rainDropCount);
+            }
+        }
+        lastFrameStart = frameStart;
+        if (scenarioMode && SDL_GetTicks() - scenarioStart >= scenario.seconds * 1000) {
+            running = false;
+        }
+        profiler.endFrame(obstacleCount);
 
-        SDL_Delay(16);
+        if (!vsyncEnabled) {
+            waitForNextFrame(frameStart);
+        }
+    }
+    // A game still in progress at quit is written as far as it got.
+    simThread.stop();
+    finishRecording(false);
+    profiler.mergeTrace(simThread.getProfiler());
+    profiler.stopTrace();
+    audio.printStats();
+    printLatency();
+    printAllocations();
+    if (ghostNet.isOpen()) {
+        ghostNet.printStats();
     }
 }
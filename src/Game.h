@@ -5,56 +5,168 @@
 #include <SDL_image.h>
 #include <SDL_mixer.h>
 #include <SDL_ttf.h>
+#include <memory>
 #include <vector>
-#include "GameObject.h"
-#include "WeatherSystem.h"
+#include "AssetLoader.h"
+#include "AudioSystem.h"
+#include "AutoPilot.h"
+#include "FrameArena.h"
+#include "GhostNet.h"
+#include "Simulation.h"
 #include "HighScore.h"
+#include "InputLatency.h"
+#include "InputLog.h"
+#include "JobSystem.h"
+#include "PackFile.h"
+#include "Profiler.h"
+#include "RenderLayer.h"
+#include "Scenario.h"
+#include "SimThread.h"
+#include "SpriteBatch.h"
+#include "TextRenderer.h"
 
 class Game {
 public:
     Game();
     ~Game();
     bool init();
+    // Records a Chrome trace_event JSON file of the whole session.
+    void enableTrace(const std::string& path);
+    // Writes the input log of each new game to `path` when it ends or is saved
+    // (later games overwrite earlier ones). Games resumed from a save are not recorded.
+    void enableRecording(const std::string& path);
+    // Uses this seed for every game instead of a random one.
+    void setSeed(uint64_t seed);
+    // Audio device buffer in frames (rounded up to a power of two); call before init().
+    void setAudioBufferSize(int frames);
+    // Reads the newest mouse position right before drawing each frame and
+    // draws the player ahead of the simulation toward it. F4 toggles it.
+    void setLateLatch(bool enabled);
+    // Runs the scenario instead of the menu: software renderer, no input
+    // needed, and run() returns once its time is up. Call before init().
+    void setScenario(const ScenarioConfig& config);
+    // Prints and writes the scenario's report; call after run().
+    bool writeScenarioReport() const;
+    // Races against other players: streams this player to `peer` (a relay
+    // or another game) from `port` and draws the ghosts that come back.
+    bool enableGhosts(uint16_t port, const NetAddress& peer);
+    // Loss, latency and jitter added to every ghost packet sent.
+    void setNetConditions(float lossPercent, float latencyMs, float jitterMs);
     void run();
 
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
-    SDL_Texture* playerTexture;
-    SDL_Texture* obstacleTexture;
     SDL_Texture* backgroundTexture;
-    SDL_Texture* logoTexture;
-    Mix_Music* bgMusic;
+    SpriteBatch sprites;
+    AudioSystem audio;
+    int audioBufferFrames;
     Mix_Chunk* hitSound;
     TTF_Font* font;
     SDL_Color textColor = {255, 255, 255, 255};
     SDL_Color highlightColor = {255, 255, 0, 255};
-    float playerX, playerY;
+    TextRenderer textRenderer;
+    int titleText;
+    int menuTexts[4];
+    int saveHintText;
+    int demoText;
+    int weatherTexts[3];
+    int readyText;
+    int gameOverText;
+    int returnHintText;
+    // Screens drawn once and then only copied: background, logo and fixed text.
+    RenderLayer menuLayer, gameOverLayer, playfieldLayer;
+    // One text line each, redrawn only when the value shown changes.
+    RenderLayer scoreHud, saveHintHud, timerHud, weatherHud, flashHud;
+    // Latest mouse target; sent to the simulation once per batch of events.
     float targetX, targetY;
-    std::vector<GameObject> objects;
+    bool targetMoved;
+    // Input to present latency. Every command sent to the simulation gets the
+    // next sequence number; latchedSeq is the newest one drawn ahead of it.
+    InputLatency latency;
+    bool lateLatch;
+    uint32_t inputSeq;
+    uint32_t latchedSeq;
+    // Event times of the motion events folded into the next TARGET command.
+    std::vector<InputLatency::Clock::time_point> pendingMotion;
     bool running;
-    Uint32 lastSpawnTime;
-    Uint32 gameStartTime;
-    Uint32 lastFlashTime;
-    int score;
-    float currentObjectSpeed;
-    int currentSpawnInterval;
-    enum class GameState { MENU, PLAYING, PLAYING_SURVIVAL, GAME_OVER };
+    bool vsyncEnabled;
+    Uint64 perfFrequency;
+    Uint64 framePeriod;
+    // Transient per-frame data; reset at the start of every frame.
+    FrameArena frameArena;
+    // Heap allocations made while a game is shown: by the game thread in
+    // the last frame and in total, and by the simulation thread (read from
+    // the snapshots, whose thread starts from zero every game).
+    uint64_t frameAllocations;
+    uint64_t playingFrames, allocatingFrames, playingAllocations;
+    uint64_t simAllocations, lastSimAllocations;
+    GhostNet ghostNet;
+    GhostSampler ghostSampler;
+    enum class GameState { MENU, PLAYING, GAME_OVER };
     GameState state;
+    // Rules of the game being played, for the HUD and the save key.
+    const GameModeInfo* modeInfo;
     int menuSelection;
-    WeatherSystem weatherSystem;
+    bool scenarioMode;
+    ScenarioConfig scenario;
+    ScenarioReport scenarioReport;
+    Uint32 scenarioStart;
+    Uint64 lastFrameStart;
+    // Attract mode: after a while in the menu without input, the AutoPilot
+    // plays a classic game until a key or button is pressed.
+    AutoPilot autoPilot;
+    bool demo;
+    Uint32 lastMenuInput;
+    // Used by the simulation thread for large obstacle counts.
+    JobSystem jobs;
+    // Owned by simThread while a game runs; the game thread only reads it
+    // (or saves/loads it) while the thread is stopped.
+    Simulation simulation;
+    Profiler profiler;
+    SimThread simThread;
+    uint64_t lastSimPhaseTime[PROFILE_PHASE_COUNT];
     HighScore highScore;
+    InputLog inputLog;
+    std::string recordPath;
+    bool recording;
+    bool seedFixed;
+    uint64_t fixedSeed;
+    // Kept open for the whole run: packed sound and music play from the mapping.
+    PackFile pack;
+    std::unique_ptr<AssetLoader> assetLoader;
+    int backgroundJob, fontJob, soundJob;
+    int spriteJobs[SPRITE_COUNT];
+    SDL_Surface* spriteSurfaces[SPRITE_COUNT];
 
     bool initSDL();
     bool loadAssets();
-    bool checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2);
-    float distance(float x1, float y1, float x2, float y2);
-    void movePlayerToTarget();
-    void saveGameState();
-    bool loadGameState();
-    void updateScore();
-    void updateObjectSpeed();
+    bool loadPackedAssets();
+    void cacheTexts();
+    bool initLayers();
+    void invalidateLayers();
+    bool processLoadedAsset(int id);
+    bool pumpAssets(bool waitForAll);
+    void startGame(GameMode mode);
+    void startSimulation();
+    void startDemo();
+    void startScenarioGame();
+    void endDemo();
+    void finishRecording(bool saved);
+    void handleEvents();
+    InputLatency::Clock::time_point eventTime(const SDL_Event& event) const;
+    void sendTarget();
+    void latchInput();
+    void printLatency() const;
+    void printAllocations() const;
+    void updateGhosts(const WorldSnapshot* snapshot);
+    void renderGhosts();
+    void updatePlaying(const WorldSnapshot& snapshot);
+    void waitForNextFrame(Uint64 frameStart);
     void renderMenu();
+    void renderPlaying(const WorldSnapshot& snapshot);
+    void renderGameOver();
+    void renderProfilerOverlay();
 };
 
 #endif
@@ -0,0 +1,85 @@
+#ifndef GAME_MODES_H
+#define GAME_MODES_H
+
+#include <algorithm>
+#include <cstdint>
+#include "Constants.h"
+
+enum class GameMode { CLASSIC, SURVIVAL_RUSH };
+const int GAME_MODE_COUNT = 2;
+
+// The rules that differ between modes, as compile-time policies: spawn
+// schedule, obstacle speed curve, weather cadence, end condition and scoring.
+// Simulation instantiates its step once per policy, so a tick never branches
+// on the mode. A new mode is a new policy, an enum value and an entry in
+// getModeInfo() and Simulation's step table.
+struct ClassicMode {
+    static constexpr GameMode ID = GameMode::CLASSIC;
+    static constexpr int INITIAL_SPAWN_INTERVAL = SPAWN_INTERVAL;
+    static constexpr uint32_t WEATHER_INTERVAL = CLASSIC_WEATHER_INTERVAL;
+    static constexpr uint32_t WEATHER_DURATION = CLASSIC_WEATHER_DURATION;
+    // 0 = no time limit; only a collision ends the game.
+    static constexpr int TIME_LIMIT = 0;
+    static constexpr bool CAN_SAVE = true;
+
+    // Spawns come faster every 30 s, down to SPAWN_INTERVAL_MIN.
+    static int spawnInterval(double elapsedTime, int current) {
+        int decreaseCount = static_cast<int>(elapsedTime / 30000);
+        if (decreaseCount > 0) {
+            return std::max(SPAWN_INTERVAL - (decreaseCount * SPAWN_INTERVAL_DECREASE_RATE), SPAWN_INTERVAL_MIN);
+        }
+        return current;
+    }
+    static float objectSpeed(double elapsedTime, float) {
+        int steps = static_cast<int>(elapsedTime / SPEED_INCREASE_INTERVAL);
+        return INITIAL_OBJECT_SPEED + steps * SPEED_INCREMENT;
+    }
+    static int score(double elapsedTime) {
+        return static_cast<int>(elapsedTime / 1000) * 10; // 1 second = 10 points
+    }
+};
+
+struct SurvivalRushMode {
+    static constexpr GameMode ID = GameMode::SURVIVAL_RUSH;
+    static constexpr int INITIAL_SPAWN_INTERVAL = SPAWN_INTERVAL_SURVIVAL;
+    static constexpr uint32_t WEATHER_INTERVAL = SURVIVAL_WEATHER_INTERVAL;
+    static constexpr uint32_t WEATHER_DURATION = SURVIVAL_WEATHER_DURATION;
+    static constexpr int TIME_LIMIT = SURVIVAL_RUSH_DURATION;
+    static constexpr bool CAN_SAVE = false;
+
+    // Constant pressure from the start.
+    static int spawnInterval(double, int current) {
+        return current;
+    }
+    static float objectSpeed(double, float current) {
+        return current;
+    }
+    static int score(double elapsedTime) {
+        return ClassicMode::score(elapsedTime);
+    }
+};
+
+// The same facts at run time, for the menu, HUD and tools.
+struct GameModeInfo {
+    GameMode id;
+    const char* name;  // short, for files and the command line
+    const char* title; // shown in the menu
+    int initialSpawnInterval;
+    int timeLimit;
+    bool canSave;
+};
+
+template <typename Mode>
+constexpr GameModeInfo describeMode(const char* name, const char* title) {
+    return {Mode::ID, name, title, Mode::INITIAL_SPAWN_INTERVAL, Mode::TIME_LIMIT, Mode::CAN_SAVE};
+}
+
+inline const GameModeInfo& getModeInfo(GameMode mode) {
+    static const GameModeInfo infos[GAME_MODE_COUNT] = {
+        describeMode<ClassicMode>("classic", "Classic"),
+        describeMode<SurvivalRushMode>("survival", "Survival Rush"),
+    };
+    return infos[static_cast<int>(mode)];
+}
+
+#endif
@@ -1,12 +1,11 @@
 #ifndef GAME_OBJECT_H
 #define GAME_OBJECT_H
 
-#include <SDL.h>
+class Random;
 
 struct GameObject {
     float x, y;
     float dx, dy;
-    SDL_Texture* texture;
 };
 
 struct RainDrop {
@@ -15,4 +14,7 @@ struct RainDrop {
     int length;
 };
 
+GameObject spawnObject(float currentObjectSpeed, Random& random);
+RainDrop spawnRainDrop(Random& random);
+
 #endif
@@ -0,0 +1,240 @@
+#include "GhostNet.h"
+#include "BitStream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+GhostNet::GhostNet()
+    : peer(), ghosts(), openedMs(0), nextSendMs(0), stats(), windowStartMs(0), windowBytesSent(0),
+      windowBytesReceived(0) {}
+
+bool GhostNet::open(uint16_t localPort, const NetAddress& peerAddress) {
+    if (!socket.open(localPort)) {
+        return false;
+    }
+    peer = peerAddress;
+    double now = getTimeMs();
+    idRandom.seed(static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()),
+                  socket.getLocalPort());
+    for (RemoteGhost& ghost : ghosts) ghost.active = false;
+    pickGhostId();
+    stats = GhostNetStats();
+    openedMs = now;
+    nextSendMs = now;
+    windowStartMs = now;
+    windowBytesSent = 0;
+    windowBytesReceived = 0;
+    return true;
+}
+
+void GhostNet::close() {
+    socket.close();
+}
+
+bool GhostNet::isOpen() const {
+    return socket.isOpen();
+}
+
+void GhostNet::setConditions(float lossPercent, float latencyMs, float jitterMs) {
+    link.setConditions(lossPercent, latencyMs, jitterMs);
+}
+
+void GhostNet::publish(const GhostState& state) {
+    if (!isOpen()) {
+        return;
+    }
+    double now = getTimeMs();
+    if (now < nextSendMs) {
+        return;
+    }
+    // Keeps the average rate after a long frame without bursting to catch up.
+    const double interval = 1000.0 / GHOST_SEND_RATE;
+    nextSendMs = std::max(nextSendMs + interval, now - interval);
+    uint8_t packet[GHOST_MAX_PACKET];
+    size_t size = encoder.encode(state, packet, sizeof(packet));
+    if (size > 0) {
+        send(packet, size, now);
+    }
+}
+
+void GhostNet::update() {
+    if (!isOpen()) {
+        return;
+    }
+    double now = getTimeMs();
+    LinkSimulator::Packet delayed;
+    while (link.release(now, delayed)) {
+        socket.sendTo(delayed.to, delayed.data, delayed.size);
+    }
+    NetAddress from;
+    uint8_t packet[GHOST_MAX_PACKET];
+    int size;
+    while ((size = socket.receiveFrom(from, packet, sizeof(packet))) > 0) {
+        receive(from, packet, static_cast<size_t>(size), now);
+    }
+    for (RemoteGhost& ghost : ghosts) {
+        if (ghost.active && now - ghost.lastHeardMs > GHOST_TIMEOUT_MS) {
+            ghost.active = false;
+        }
+    }
+    if (now - windowStartMs >= 1000) {
+        double seconds = (now - windowStartMs) / 1000.0;
+        stats.sendBytesPerSecond = windowBytesSent / seconds;
+        stats.receiveBytesPerSecond = windowBytesReceived / seconds;
+        windowStartMs = now;
+        windowBytesSent = 0;
+        windowBytesReceived = 0;
+    }
+}
+
+void GhostNet::send(const uint8_t* data, size_t size, double nowMs) {
+    ++stats.packetsSent;
+    stats.bytesSent += size;
+    windowBytesSent += size;
+    if (link.isPerfect()) {
+        socket.sendTo(peer, data, size);
+    } else {
+        link.submit(peer, data, size, nowMs);
+    }
+}
+
+void GhostNet::receive(const NetAddress&, const uint8_t* data, size_t size, double nowMs) {
+    ++stats.packetsReceived;
+    stats.bytesReceived += size;
+    windowBytesReceived += size;
+    BitReader reader(data, size);
+    GhostPacketHeader header;
+    if (!readGhostHeader(reader, header)) {
+        return;
+    }
+    if (header.type == GhostPacketType::ACK) {
+        if (header.ghostId == encoder.getGhostId()) {
+            encoder.acknowledge(header.sequence);
+        }
+        return;
+    }
+    if (header.ghostId == encoder.getGhostId()) {
+        // Our own snapshots never come back (the relay skips the sender), so
+        // this is another player who drew the same id.
+        uint8_t taken = header.ghostId;
+        pickGhostId();
+        std::printf("Ghost id %u is taken, switching to %u\n", taken, encoder.getGhostId());
+        std::fflush(stdout);
+    }
+    RemoteGhost* ghost = findGhost(header.ghostId, nowMs);
+    if (!ghost) {
+        return;
+    }
+    GhostState state;
+    if (!ghost->decoder.decode(reader, header, state)) {
+        ++stats.undecodable;
+        return;
+    }
+    ghost->lastHeardMs = nowMs;
+    // Acked even when late: the sender may still use it as a baseline.
+    uint8_t ack[GHOST_MAX_PACKET];
+    size_t ackSize = writeGhostAck(header.ghostId, header.sequence, ack, sizeof(ack));
+    if (ackSize > 0) {
+        send(ack, ackSize, nowMs);
+    }
+    if (ghost->decoder.getLatestSequence() != header.sequence) {
+        return;
+    }
+    // A Flash is a jump; it is not drawn as a slide.
+    bool flashed = state.flashCount != ghost->state.flashCount;
+    if (flashed) {
+        ghost->lastFlashMs = nowMs;
+    }
+    ghost->previous = flashed || ghost->receivedMs < 0 ? state : ghost->state;
+    ghost->state = state;
+    ghost->receivedMs = nowMs;
+}
+
+RemoteGhost* GhostNet::findGhost(uint8_t id, double nowMs) {
+    RemoteGhost* free = nullptr;
+    for (RemoteGhost& ghost : ghosts) {
+        if (ghost.active && ghost.id == id) {
+            return &ghost;
+        }
+        if (!ghost.active && !free) {
+            free = &ghost;
+        }
+    }
+    if (free) {
+        free->active = true;
+        free->id = id;
+        free->state = GhostState();
+        free->previous = GhostState();
+        free->receivedMs = -1;
+        free->lastHeardMs = nowMs;
+        free->lastFlashMs = -1;
+        free->decoder.reset();
+    }
+    return free;
+}
+
+// Random, so that players who start together rarely collide, and never one
+// already seen or the id in use: a collision found in receive() then always
+// moves away from it. Restarting the encoder drops the baselines acked under
+// the old id, since acks for the other player carried it too.
+void GhostNet::pickGhostId() {
+    uint8_t current = encoder.getGhostId();
+    uint8_t id;
+    bool taken;
+    do {
+        id = static_cast<uint8_t>(idRandom.nextInt(256));
+        taken = id == current;
+        for (const RemoteGhost& ghost : ghosts) {
+            taken = taken || (ghost.active && ghost.id == id);
+        }
+    } while (taken);
+    encoder.reset(id);
+}
+
+const RemoteGhost* GhostNet::getGhost(int slot) const {
+    return ghosts[slot].active ? &ghosts[slot] : nullptr;
+}
+
+void GhostNet::getGhostPosition(const RemoteGhost& ghost, float& x, float& y) const {
+    float alpha = 1;
+    if (ghost.receivedMs >= 0) {
+        double since = (getTimeMs() - ghost.receivedMs) * GHOST_SEND_RATE / 1000.0;
+        alpha = static_cast<float>(std::min(std::max(since, 0.0), 1.0));
+    }
+    float previousX = ghostToPixels(ghost.previous.x);
+    float previousY = ghostToPixels(ghost.previous.y);
+    x = previousX + (ghostToPixels(ghost.state.x) - previousX) * alpha;
+    y = previousY + (ghostToPixels(ghost.state.y) - previousY) * alpha;
+}
+
+double GhostNet::getTimeMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint8_t GhostNet::getGhostId() const {
+    return encoder.getGhostId();
+}
+
+GhostNetStats GhostNet::getStats() const {
+    GhostNetStats result = stats;
+    result.packetsDropped = link.getDroppedCount();
+    result.absolutePackets = encoder.getAbsoluteCount();
+    return result;
+}
+
+void GhostNet::printStats() const {
+    GhostNetStats result = getStats();
+    double seconds = (getTimeMs() - openedMs) / 1000.0;
+    if (seconds <= 0) {
+        seconds = 1;
+    }
+    std::printf("Ghosts: sent %llu packets (%.0f B/s, %.1f B/packet, %llu absolute, %llu dropped by the link), "
+                "received %llu packets (%.0f B/s, %llu undecodable)\n",
+                static_cast<unsigned long long>(result.packetsSent), result.bytesSent / seconds,
+                result.packetsSent ? static_cast<double>(result.bytesSent) / result.packetsSent : 0.0,
+                static_cast<unsigned long long>(result.absolutePackets),
+                static_cast<unsigned long long>(result.packetsDropped),
+                static_cast<unsigned long long>(result.packetsReceived), result.bytesReceived / seconds,
+                static_cast<unsigned long long>(result.undecodable));
+    std::fflush(stdout);
+}
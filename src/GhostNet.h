@@ -0,0 +1,88 @@
+#ifndef GHOST_NET_H
+#define GHOST_NET_H
+
+#include <cstdint>
+#include "GhostProtocol.h"
+#include "LinkSimulator.h"
+#include "Random.h"
+#include "UdpSocket.h"
+
+// A player seen through the network.
+struct RemoteGhost {
+    bool active;
+    uint8_t id;
+    GhostState state;
+    // The snapshot before `state` and when `state` arrived, to interpolate.
+    GhostState previous;
+    double receivedMs;
+    double lastHeardMs;
+    double lastFlashMs; // when its flash count last changed, or -1
+    GhostDecoder decoder;
+};
+
+struct GhostNetStats {
+    uint64_t packetsSent, bytesSent;
+    uint64_t packetsReceived, bytesReceived;
+    uint64_t packetsDropped;  // by the link simulator
+    uint64_t absolutePackets; // snapshots sent without a baseline
+    uint64_t undecodable;     // deltas against a baseline that never arrived
+    // UDP payload over the last full second.
+    double sendBytesPerSecond, receiveBytesPerSecond;
+};
+
+// Ghost race over UDP: streams the local player to one peer (another game or
+// dodge_relay) and keeps up to MAX_GHOSTS remote players from what comes
+// back. Everything is non-blocking and in fixed arrays, so calling it every
+// frame neither waits nor allocates. Outgoing packets (snapshots and acks)
+// can be put through a LinkSimulator to try loss, latency and jitter.
+class GhostNet {
+public:
+    static const int MAX_GHOSTS = 8;
+
+    GhostNet();
+    // Binds `localPort` (0 = any) and picks a random ghost id. Another
+    // player's snapshot carrying that id makes it pick a new one.
+    bool open(uint16_t localPort, const NetAddress& peer);
+    void close();
+    bool isOpen() const;
+    void setConditions(float lossPercent, float latencyMs, float jitterMs);
+
+    // Sends the local player at GHOST_SEND_RATE at most; call every frame.
+    void publish(const GhostState& state);
+    // Sends what the link released, reads every waiting packet and forgets
+    // ghosts that went quiet. Call every frame.
+    void update();
+
+    // nullptr if the slot is free.
+    const RemoteGhost* getGhost(int slot) const;
+    // Where to draw a ghost now, in pixels: moving from its previous snapshot
+    // to the latest over one send interval, so it trails by about that much.
+    void getGhostPosition(const RemoteGhost& ghost, float& x, float& y) const;
+    // The clock of lastHeardMs and lastFlashMs.
+    double getTimeMs() const;
+    uint8_t getGhostId() const;
+    GhostNetStats getStats() const;
+    void printStats() const;
+
+private:
+    static constexpr double GHOST_TIMEOUT_MS = 3000;
+
+    UdpSocket socket;
+    NetAddress peer;
+    LinkSimulator link;
+    GhostEncoder encoder;
+    Random idRandom;
+    RemoteGhost ghosts[MAX_GHOSTS];
+    double openedMs;
+    double nextSendMs;
+    GhostNetStats stats;
+    double windowStartMs;
+    uint64_t windowBytesSent, windowBytesReceived;
+
+    void send(const uint8_t* data, size_t size, double nowMs);
+    void receive(const NetAddress& from, const uint8_t* data, size_t size, double nowMs);
+    RemoteGhost* findGhost(uint8_t id, double nowMs);
+    void pickGhostId();
+};
+
+#endif
@@ -0,0 +1,269 @@
+#include "GhostProtocol.h"
+#include "BitStream.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const uint32_t GHOST_MAGIC = 0xD6;
+const int MAGIC_BITS = 8;
+const int SEQUENCE_BITS = 16;
+const int BASELINE_BITS = 6;
+const int POSITION_BITS = 12;       // quarter pixels, up to 1023.75 px
+const int POSITION_DELTA_BITS = 10; // +-128 px from the baseline
+const int TICK_DELTA_BITS = 6;      // 1..64 ticks after the baseline
+const int SCORE_DELTA_BITS = 10;
+const int STATUS_BITS = 2;
+
+// True if sequence a is newer than b, allowing for wrap-around.
+bool sequenceNewer(uint16_t a, uint16_t b) {
+    return static_cast<int16_t>(a - b) > 0;
+}
+
+uint16_t toQuarterPixels(float pixels) {
+    int value = static_cast<int>(std::lround(pixels * 4));
+    return static_cast<uint16_t>(std::min(std::max(value, 0), (1 << POSITION_BITS) - 1));
+}
+
+void writeHeader(BitWriter& writer, GhostPacketType type, uint8_t ghostId, uint16_t sequence) {
+    writer.writeBits(GHOST_MAGIC, MAGIC_BITS);
+    writer.writeBool(type == GhostPacketType::ACK);
+    writer.writeBits(ghostId, 8);
+    writer.writeBits(sequence, SEQUENCE_BITS);
+}
+
+void writePosition(BitWriter& writer, uint16_t value, const uint16_t* baseline) {
+    if (baseline) {
+        if (value == *baseline) {
+            writer.writeBool(false);
+            return;
+        }
+        writer.writeBool(true);
+        int32_t delta = static_cast<int32_t>(value) - *baseline;
+        bool small = fitsSigned(delta, POSITION_DELTA_BITS);
+        writer.writeBool(small);
+        if (small) {
+            writer.writeSigned(delta, POSITION_DELTA_BITS);
+            return;
+        }
+    }
+    writer.writeBits(value, POSITION_BITS);
+}
+
+uint16_t readPosition(BitReader& reader, const uint16_t* baseline) {
+    if (baseline) {
+        if (!reader.readBool()) {
+            return *baseline;
+        }
+        if (reader.readBool()) {
+            return static_cast<uint16_t>(*baseline + reader.readSigned(POSITION_DELTA_BITS));
+        }
+    }
+    return static_cast<uint16_t>(reader.readBits(POSITION_BITS));
+}
+
+// Field by field against `base`, or every field in full without one.
+void writeState(BitWriter& writer, const GhostState& state, const GhostState* base) {
+    if (base) {
+        uint32_t tickDelta = state.tick - base->tick;
+        bool small = tickDelta >= 1 && tickDelta <= (1u << TICK_DELTA_BITS);
+        writer.writeBool(small);
+        if (small) {
+            writer.writeBits(tickDelta - 1, TICK_DELTA_BITS);
+        } else {
+            writer.writeBits(state.tick, 32);
+        }
+    } else {
+        writer.writeBits(state.tick, 32);
+    }
+    writePosition(writer, state.x, base ? &base->x : nullptr);
+    writePosition(writer, state.y, base ? &base->y : nullptr);
+
+    if (!base || state.flashCount != base->flashCount) {
+        if (base) writer.writeBool(true);
+        writer.writeBits(state.flashCount, 8);
+    } else {
+        writer.writeBool(false);
+    }
+    if (!base || state.status != base->status) {
+        if (base) writer.writeBool(true);
+        writer.writeBits(state.status, STATUS_BITS);
+    } else {
+        writer.writeBool(false);
+    }
+    if (base && state.score == base->score) {
+        writer.writeBool(false);
+    } else {
+        if (base) writer.writeBool(true);
+        int32_t delta = base ? state.score - base->score : -1;
+        bool small = delta >= 0 && delta < (1 << SCORE_DELTA_BITS);
+        writer.writeBool(small);
+        if (small) {
+            writer.writeBits(static_cast<uint32_t>(delta), SCORE_DELTA_BITS);
+        } else {
+            writer.writeBits(static_cast<uint32_t>(state.score), 32);
+        }
+    }
+}
+
+// False for a score delta without a baseline, which the encoder never writes.
+bool readState(BitReader& reader, GhostState& state, const GhostState* base) {
+    if (base && reader.readBool()) {
+        state.tick = base->tick + reader.readBits(TICK_DELTA_BITS) + 1;
+    } else {
+        state.tick = reader.readBits(32);
+    }
+    state.x = readPosition(reader, base ? &base->x : nullptr);
+    state.y = readPosition(reader, base ? &base->y : nullptr);
+    state.flashCount = (!base || reader.readBool()) ? static_cast<uint8_t>(reader.readBits(8)) : base->flashCount;
+    state.status = (!base || reader.readBool()) ? static_cast<uint8_t>(reader.readBits(STATUS_BITS)) : base->status;
+    if (base && !reader.readBool()) {
+        state.score = base->score;
+    } else if (reader.readBool()) {
+        if (!base) {
+            return false;
+        }
+        state.score = base->score + static_cast<int32_t>(reader.readBits(SCORE_DELTA_BITS));
+    } else {
+        state.score = static_cast<int32_t>(reader.readBits(32));
+    }
+    return true;
+}
+}
+
+bool operator==(const GhostState& a, const GhostState& b) {
+    return a.tick == b.tick && a.x == b.x && a.y == b.y && a.flashCount == b.flashCount && a.status == b.status &&
+           a.score == b.score;
+}
+
+float ghostToPixels(uint16_t quarterPixels) {
+    return quarterPixels / 4.0f;
+}
+
+GhostSampler::GhostSampler() : flashCount(0), lastTimeSinceFlash(-1) {}
+
+void GhostSampler::reset() {
+    flashCount = 0;
+    lastTimeSinceFlash = -1;
+}
+
+GhostState GhostSampler::sample(uint32_t tick, float x, float y, double timeSinceFlash, SimStatus status, int score) {
+    if (lastTimeSinceFlash >= 0 && timeSinceFlash < lastTimeSinceFlash) {
+        ++flashCount;
+    }
+    lastTimeSinceFlash = timeSinceFlash;
+    GhostState state;
+    state.tick = tick;
+    state.x = toQuarterPixels(x);
+    state.y = toQuarterPixels(y);
+    state.flashCount = flashCount;
+    state.status = static_cast<uint8_t>(status);
+    state.score = score;
+    return state;
+}
+
+bool readGhostHeader(BitReader& reader, GhostPacketHeader& header) {
+    if (reader.readBits(MAGIC_BITS) != GHOST_MAGIC) {
+        return false;
+    }
+    header.type = reader.readBool() ? GhostPacketType::ACK : GhostPacketType::SNAPSHOT;
+    header.ghostId = static_cast<uint8_t>(reader.readBits(8));
+    header.sequence = static_cast<uint16_t>(reader.readBits(SEQUENCE_BITS));
+    return !reader.failed();
+}
+
+size_t writeGhostAck(uint8_t ghostId, uint16_t sequence, uint8_t* packet, size_t capacity) {
+    BitWriter writer(packet, capacity);
+    writeHeader(writer, GhostPacketType::ACK, ghostId, sequence);
+    return writer.failed() ? 0 : writer.getByteCount();
+}
+
+GhostEncoder::GhostEncoder(uint8_t ghostId) : history(), absoluteCount(0) {
+    reset(ghostId);
+}
+
+void GhostEncoder::reset(uint8_t id) {
+    ghostId = id;
+    nextSequence = 0;
+    acked = false;
+    ackedSequence = 0;
+}
+
+uint8_t GhostEncoder::getGhostId() const {
+    return ghostId;
+}
+
+size_t GhostEncoder::encode(const GhostState& state, uint8_t* packet, size_t capacity) {
+    uint16_t sequence = nextSequence;
+    uint16_t distance = static_cast<uint16_t>(sequence - ackedSequence);
+    bool delta = acked && distance >= 1 && distance < HISTORY;
+    BitWriter writer(packet, capacity);
+    writeHeader(writer, GhostPacketType::SNAPSHOT, ghostId, sequence);
+    writer.writeBits(delta ? distance : 0, BASELINE_BITS);
+    writeState(writer, state, delta ? &history[ackedSequence % HISTORY] : nullptr);
+    if (writer.failed()) {
+        return 0;
+    }
+    if (!delta) {
+        ++absoluteCount;
+    }
+    history[sequence % HISTORY] = state;
+    ++nextSequence;
+    return writer.getByteCount();
+}
+
+void GhostEncoder::acknowledge(uint16_t sequence) {
+    // Only packets that were sent and are still in the history are usable.
+    uint16_t age = static_cast<uint16_t>(nextSequence - sequence);
+    if (age == 0 || age >= HISTORY) {
+        return;
+    }
+    if (!acked || sequenceNewer(sequence, ackedSequence)) {
+        acked = true;
+        ackedSequence = sequence;
+    }
+}
+
+uint64_t GhostEncoder::getAbsoluteCount() const {
+    return absoluteCount;
+}
+
+GhostDecoder::GhostDecoder() {
+    reset();
+}
+
+void GhostDecoder::reset() {
+    any = false;
+    latestSequence = 0;
+    std::fill(historyValid, historyValid + HISTORY, false);
+}
+
+bool GhostDecoder::decode(BitReader& reader, const GhostPacketHeader& header, GhostState& state) {
+    uint16_t distance = static_cast<uint16_t>(reader.readBits(BASELINE_BITS));
+    const GhostState* base = nullptr;
+    if (distance > 0) {
+        uint16_t baseSequence = static_cast<uint16_t>(header.sequence - distance);
+        int slot = baseSequence % HISTORY;
+        if (!historyValid[slot] || historySequence[slot] != baseSequence) {
+            return false;
+        }
+        base = &history[slot];
+    }
+    GhostState decoded;
+    if (!readState(reader, decoded, base) || reader.failed()) {
+        return false;
+    }
+    int slot = header.sequence % HISTORY;
+    history[slot] = decoded;
+    historySequence[slot] = header.sequence;
+    historyValid[slot] = true;
+    if (!any || sequenceNewer(header.sequence, latestSequence)) {
+        any = true;
+        latestSequence = header.sequence;
+    }
+    state = decoded;
+    return true;
+}
+
+uint16_t GhostDecoder::getLatestSequence() const {
+    return latestSequence;
+}
@@ -0,0 +1,113 @@
+#ifndef GHOST_PROTOCOL_H
+#define GHOST_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Simulation.h"
+
+class BitReader;
+
+// Ghost race wire format. Each packet is a bit-packed snapshot of one
+// player, delta-encoded against the last snapshot the receiver acknowledged
+// (or absolute when there is none in the sender's history), or an ack.
+//
+//   header   magic 8, type 1, ghost id 8, sequence 16
+//   snapshot baseline distance 6 (0 = absolute), then per field a "changed"
+//            bit and a small delta or the absolute value
+//   ack      nothing more; acknowledges (ghost id, sequence)
+//
+// A moving player costs 8-10 bytes a packet, a few more when acks lag
+// behind, and 6 when standing still. The 28 bytes of UDP/IPv4 headers are
+// most of each datagram, so the rate is what keeps a ghost under 1 KB/s on
+// the wire (under 40 B x 20/s); receivers interpolate between snapshots.
+// With several receivers any one ack moves the baseline, so a receiver that
+// missed that packet skips the deltas built on it.
+const int GHOST_SEND_RATE = 20;
+const uint16_t GHOST_DEFAULT_PORT = 27960;
+const size_t GHOST_MAX_PACKET = 32;
+
+enum class GhostPacketType { SNAPSHOT, ACK };
+
+// One player as a ghost shows it; positions in quarter pixels.
+struct GhostState {
+    uint32_t tick;
+    uint16_t x, y;
+    uint8_t flashCount; // wraps; a change is a Flash
+    uint8_t status;     // SimStatus
+    int32_t score;
+};
+
+bool operator==(const GhostState& a, const GhostState& b);
+float ghostToPixels(uint16_t quarterPixels);
+
+// Builds ghost states from a game in progress. Flashes are counted from the
+// flash timer restarting, so nothing extra has to come out of the simulation.
+class GhostSampler {
+public:
+    GhostSampler();
+    // Call when a new game starts.
+    void reset();
+    GhostState sample(uint32_t tick, float x, float y, double timeSinceFlash, SimStatus status, int score);
+
+private:
+    uint8_t flashCount;
+    double lastTimeSinceFlash;
+};
+
+struct GhostPacketHeader {
+    GhostPacketType type;
+    uint8_t ghostId;
+    uint16_t sequence;
+};
+
+// False if the magic does not match or the packet is too short.
+bool readGhostHeader(BitReader& reader, GhostPacketHeader& header);
+size_t writeGhostAck(uint8_t ghostId, uint16_t sequence, uint8_t* packet, size_t capacity);
+
+// Sender side for one local player.
+class GhostEncoder {
+public:
+    explicit GhostEncoder(uint8_t ghostId = 0);
+    // Forgets every ack, e.g. for a new peer; the next packet is absolute.
+    void reset(uint8_t ghostId);
+    uint8_t getGhostId() const;
+    // Writes the next snapshot packet and returns its size (0 if it did not fit).
+    size_t encode(const GhostState& state, uint8_t* packet, size_t capacity);
+    // Later acks move the baseline forward; older or unknown ones are ignored.
+    void acknowledge(uint16_t sequence);
+    uint64_t getAbsoluteCount() const;
+
+private:
+    static const int HISTORY = 64; // the baseline distance field covers 1..63
+
+    uint8_t ghostId;
+    uint16_t nextSequence;
+    bool acked;
+    uint16_t ackedSequence;
+    GhostState history[HISTORY];
+    uint64_t absoluteCount;
+};
+
+// Receiver side for one remote ghost.
+class GhostDecoder {
+public:
+    GhostDecoder();
+    void reset();
+    // Decodes the rest of a snapshot packet after its header. Fails for
+    // corrupt packets and for deltas whose baseline this side never got.
+    bool decode(BitReader& reader, const GhostPacketHeader& header, GhostState& state);
+    // Newest sequence decoded so far; a packet that decodes to anything
+    // older arrived late and should not replace what is shown.
+    uint16_t getLatestSequence() const;
+
+private:
+    static const int HISTORY = 64;
+
+    bool any;
+    uint16_t latestSequence;
+    GhostState history[HISTORY];
+    uint16_t historySequence[HISTORY];
+    bool historyValid[HISTORY];
+};
+
+#endif
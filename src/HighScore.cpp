@@ -1,63 +1,153 @@
 #include "HighScore.h"
+#include "SaveFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
 #include <fstream>
 #include <iostream>
 
-HighScore::HighScore() : highScoreClassic(0), highScoreSurvivalRush(0) {}
+namespace {
+const char* FILE_TAG = "leaderboard";
+const int FILE_VERSION = 1;
+const char* MODE_TAGS[] = {"classic", "survival"};
+const char* LEGACY_FILES[] = {"highscore_classic.txt", "highscore_survivalrush.txt"};
+}
+
+HighScore::HighScore(const std::string& path) : path(path), stopping(false) {
+    worker = std::thread(&HighScore::workerLoop, this);
+}
+
+HighScore::~HighScore() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_one();
+    worker.join();
+}
 
 void HighScore::loadHighScores() {
-    std::ifstream inFileClassic("highscore_classic.txt");
-    if (!inFileClassic) {
-        highScoreClassic = 0;
+    for (auto& board : boards) {
+        board.clear();
+    }
+    std::ifstream inFile(path);
+    if (inFile) {
+        std::string tag;
+        int version = 0;
+        inFile >> tag >> version;
+        if (tag != FILE_TAG || version != FILE_VERSION) {
+            std::cerr << "Unrecognized leaderboard file " << path << std::endl;
+        } else {
+            for (int m = 0; m < MODE_COUNT && inFile; ++m) {
+                std::string modeTag;
+                int count = 0;
+                inFile >> modeTag >> count;
+                if (modeTag != MODE_TAGS[m]) break;
+                for (int i = 0; i < count && inFile; ++i) {
+                    ScoreEntry entry;
+                    if (inFile >> entry.score >> entry.timestamp >> entry.durationMs) {
+                        insertEntry(boards[m], entry);
+                    }
+                }
+            }
+        }
     } else {
-        inFileClassic >> highScoreClassic;
-        inFileClassic.close();
+        for (int m = 0; m < MODE_COUNT; ++m) {
+            std::ifstream legacyFile(LEGACY_FILES[m]);
+            int legacyScore = 0;
+            if (legacyFile >> legacyScore && legacyScore > 0) {
+                boards[m].push_back({legacyScore, 0, 0});
+            }
+        }
     }
 
-    std::ifstream inFileSurvival("highscore_survivalrush.txt");
-    if (!inFileSurvival) {
-        highScoreSurvivalRush = 0;
-    } else {
-        inFileSurvival >> highScoreSurvivalRush;
-        inFileSurvival.close();
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        persistedBoards[m] = boards[m];
     }
 }
 
-void HighScore::saveHighScores() {
-    std::ofstream outFileClassic("highscore_classic.txt");
-    if (!outFileClassic) {
-        std::cerr << "Failed to save high score (Classic)!" << std::endl;
+void HighScore::submitScore(GameMode mode, int score, double durationMs) {
+    ScoreEntry entry = {score, static_cast<int64_t>(std::time(nullptr)), static_cast<int>(durationMs)};
+    if (!insertEntry(boards[static_cast<int>(mode)], entry)) {
         return;
     }
-    outFileClassic << highScoreClassic;
-    outFileClassic.close();
-
-    std::ofstream outFileSurvival("highscore_survivalrush.txt");
-    if (!outFileSurvival) {
-        std::cerr << "Failed to save high score (Survival Rush)!" << std::endl;
-        return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back({mode, entry});
     }
-    outFileSurvival << highScoreSurvivalRush;
-    outFileSurvival.close();
+    queueReady.notify_one();
 }
 
-int HighScore::getHighScoreClassic() const {
-    return highScoreClassic;
+int HighScore::getHighScore(GameMode mode) const {
+    const std::vector<ScoreEntry>& board = boards[static_cast<int>(mode)];
+    return board.empty() ? 0 : board.front().score;
 }
 
-int HighScore::getHighScoreSurvivalRush() const {
-    return highScoreSurvivalRush;
+const std::vector<ScoreEntry>& HighScore::getLeaderboard(GameMode mode) const {
+    return boards[static_cast<int>(mode)];
 }
 
-void HighScore::updateHighScoreClassic(int score) {
-    if (score > highScoreClassic) {
-        highScoreClassic = score;
-        saveHighScores();
+// Keeps the board sorted by score (earlier runs first on ties) and trimmed to
+// LEADERBOARD_SIZE. Returns false if the entry did not make the board.
+bool HighScore::insertEntry(std::vector<ScoreEntry>& board, const ScoreEntry& entry) {
+    auto position = std::upper_bound(board.begin(), board.end(), entry,
+        [](const ScoreEntry& a, const ScoreEntry& b) { return a.score > b.score; });
+    if (position - board.begin() >= LEADERBOARD_SIZE) {
+        return false;
     }
+    board.insert(position, entry);
+    if (static_cast<int>(board.size()) > LEADERBOARD_SIZE) {
+        board.pop_back();
+    }
+    return true;
 }
 
-void HighScore::updateHighScoreSurvivalRush(int score) {
-    if (score > highScoreSurvivalRush) {
-        highScoreSurvivalRush = score;
-        saveHighScores();
+void HighScore::workerLoop() {
+    std::vector<Submission> pending;
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        // Everything queued while the previous write ran goes into one write.
+        pending.swap(queue);
+        for (const Submission& submission : pending) {
+            insertEntry(persistedBoards[static_cast<int>(submission.mode)], submission.entry);
+        }
+        pending.clear();
+        lock.unlock();
+        writeLeaderboard(persistedBoards);
+        lock.lock();
+    }
+}
+
+bool HighScore::writeLeaderboard(const std::vector<ScoreEntry> (&source)[MODE_COUNT]) const {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream outFile(tempPath, std::ios::trunc);
+        if (!outFile) {
+            std::cerr << "Failed to save high scores!" << std::endl;
+            return false;
+        }
+        outFile << FILE_TAG << " " << FILE_VERSION << "\n";
+        for (int m = 0; m < MODE_COUNT; ++m) {
+            outFile << MODE_TAGS[m] << " " << source[m].size() << "\n";
+            for (const ScoreEntry& entry : source[m]) {
+                outFile << entry.score << " " << entry.timestamp << " " << entry.durationMs << "\n";
+            }
+        }
+        outFile.flush();
+        if (!outFile) {
+            std::cerr << "Failed to save high scores!" << std::endl;
+            return false;
+        }
+    }
+    if (!replaceFile(tempPath, path)) {
+        std::cerr << "Failed to replace " << path << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
     }
+    return true;
 }
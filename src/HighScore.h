@@ -1,19 +1,64 @@
 #ifndef HIGH_SCORE_H
 #define HIGH_SCORE_H
 
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+
+struct ScoreEntry {
+    int score;
+    int64_t timestamp;  // Unix seconds; 0 for scores imported from the old files
+    int durationMs;
+};
+
+// Top-N runs per game mode. The game thread only reads and updates the
+// in-memory copy; submissions are queued to a worker thread that merges them
+// into its own copy and rewrites the leaderboard file (write to a temporary
+// file, then rename over the old one).
 class HighScore {
 public:
-    HighScore();
+    static const int LEADERBOARD_SIZE = 10;
+
+    explicit HighScore(const std::string& path = "leaderboard.txt");
+    // Writes any queued scores before returning.
+    ~HighScore();
+    HighScore(const HighScore&) = delete;
+    HighScore& operator=(const HighScore&) = delete;
+
+    // Reads the leaderboard, or the old single-score files if there is none
+    // yet. Blocking; call once at startup.
     void loadHighScores();
-    void saveHighScores();
-    int getHighScoreClassic() const;
-    int getHighScoreSurvivalRush() const;
-    void updateHighScoreClassic(int score);
-    void updateHighScoreSurvivalRush(int score);
+    void submitScore(GameMode mode, int score, double durationMs);
+    int getHighScore(GameMode mode) const;
+    const std::vector<ScoreEntry>& getLeaderboard(GameMode mode) const;
 
 private:
-    int highScoreClassic;
-    int highScoreSurvivalRush;
+    static const int MODE_COUNT = 2;
+
+    struct Submission {
+        GameMode mode;
+        ScoreEntry entry;
+    };
+
+    std::string path;
+    std::vector<ScoreEntry> boards[MODE_COUNT];
+
+    // Shared with the worker.
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::vector<Submission> queue;
+    bool stopping;
+    // Worker-owned after loadHighScores().
+    std::vector<ScoreEntry> persistedBoards[MODE_COUNT];
+    std::thread worker;
+
+    void workerLoop();
+    bool writeLeaderboard(const std::vector<ScoreEntry> (&source)[MODE_COUNT]) const;
+    static bool insertEntry(std::vector<ScoreEntry>& board, const ScoreEntry& entry);
 };
 
 #endif
@@ -0,0 +1,109 @@
+#include "InputLatency.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+// True if sequence a is at or before b, allowing for wrap-around.
+bool seqReached(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) <= 0;
+}
+}
+
+InputLatency::InputLatency() : buckets(), count(0), totalMs(0), maxMs(0) {
+    pending.reserve(MAX_PENDING);
+}
+
+void InputLatency::reset() {
+    pending.clear();
+    std::fill(buckets, buckets + BUCKET_COUNT, 0);
+    count = 0;
+    totalMs = 0;
+    maxMs = 0;
+}
+
+void InputLatency::discardPending() {
+    pending.clear();
+}
+
+void InputLatency::inputSent(uint32_t seq, Clock::time_point eventTime, bool predicted) {
+    if (pending.size() == MAX_PENDING) {
+        pending.erase(pending.begin());
+    }
+    pending.push_back({seq, eventTime, predicted});
+}
+
+void InputLatency::framePresented(uint32_t simSeq, uint32_t latchedSeq, Clock::time_point presentTime) {
+    size_t kept = 0;
+    for (const Pending& input : pending) {
+        bool shown = seqReached(input.seq, simSeq) || (input.predicted && seqReached(input.seq, latchedSeq));
+        if (!shown) {
+            pending[kept++] = input;
+            continue;
+        }
+        double ms = std::chrono::duration<double, std::milli>(presentTime - input.eventTime).count();
+        ms = std::max(ms, 0.0);
+        int bucket = std::min(static_cast<int>(ms / BUCKET_MS), BUCKET_COUNT - 1);
+        ++buckets[bucket];
+        ++count;
+        totalMs += ms;
+        maxMs = std::max(maxMs, ms);
+    }
+    pending.resize(kept);
+}
+
+uint64_t InputLatency::getCount() const {
+    return count;
+}
+
+double InputLatency::getPercentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min((i + 1) * BUCKET_MS, maxMs);
+        }
+    }
+    return maxMs;
+}
+
+double InputLatency::getMax() const {
+    return maxMs;
+}
+
+// One row per millisecond up to the slowest input, bars scaled to the
+// fullest row.
+void InputLatency::printReport(const char* label) const {
+    std::printf("Input to present latency (%s): %llu inputs", label, static_cast<unsigned long long>(count));
+    if (count == 0) {
+        std::printf("\n");
+        std::fflush(stdout);
+        return;
+    }
+    std::printf(", avg %.2f p50 %.2f p95 %.2f p99 %.2f max %.2f ms\n", totalMs / count, getPercentile(50),
+                getPercentile(95), getPercentile(99), maxMs);
+    const int perRow = static_cast<int>(1.0 / BUCKET_MS);
+    int rows = std::min(static_cast<int>(maxMs) + 1, BUCKET_COUNT / perRow);
+    uint64_t fullest = 1;
+    for (int row = 0; row < rows; ++row) {
+        uint64_t rowCount = 0;
+        for (int i = row * perRow; i < (row + 1) * perRow; ++i) rowCount += buckets[i];
+        fullest = std::max(fullest, rowCount);
+    }
+    for (int row = 0; row < rows; ++row) {
+        uint64_t rowCount = 0;
+        for (int i = row * perRow; i < (row + 1) * perRow; ++i) rowCount += buckets[i];
+        if (row == rows - 1 && rows == BUCKET_COUNT / perRow) {
+            std::printf("  %3d+ ms %8llu ", row, static_cast<unsigned long long>(rowCount));
+        } else {
+            std::printf("  %3d ms  %8llu ", row, static_cast<unsigned long long>(rowCount));
+        }
+        int width = static_cast<int>(rowCount * 50 / fullest);
+        for (int i = 0; i < width; ++i) std::putchar('#');
+        std::putchar('\n');
+    }
+    std::fflush(stdout);
+}
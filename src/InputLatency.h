@@ -0,0 +1,54 @@
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Histogram of the time from an input event to the return of the
+// SDL_RenderPresent of the first frame that shows it (input to photon, minus
+// the display's own scan-out). Inputs are tagged with the sequence number of
+// the simulation command that carries them; the game reports which commands
+// each presented frame reflects.
+class InputLatency {
+public:
+    typedef std::chrono::steady_clock Clock;
+    static const int BUCKET_COUNT = 200;
+    static constexpr double BUCKET_MS = 0.5; // the last bucket is open-ended
+
+    InputLatency();
+    // Drops the histogram and any inputs still waiting for a frame.
+    void reset();
+    // Forgets inputs that no frame has shown yet (the game they were for ended).
+    void discardPending();
+    // `predicted` inputs are drawn ahead of the simulation (late-latched
+    // motion), so a frame can show them before the simulation consumed them.
+    void inputSent(uint32_t seq, Clock::time_point eventTime, bool predicted);
+    // A frame was presented that shows the simulation up to command simSeq
+    // and predicted input up to latchedSeq.
+    void framePresented(uint32_t simSeq, uint32_t latchedSeq, Clock::time_point presentTime);
+
+    uint64_t getCount() const;
+    // Milliseconds, to bucket precision.
+    double getPercentile(double p) const;
+    double getMax() const;
+    void printReport(const char* label) const;
+
+private:
+    // Bounds the backlog when frames stop being presented (e.g. a stall).
+    static const size_t MAX_PENDING = 4096;
+
+    struct Pending {
+        uint32_t seq;
+        Clock::time_point eventTime;
+        bool predicted;
+    };
+
+    std::vector<Pending> pending;
+    uint64_t buckets[BUCKET_COUNT];
+    uint64_t count;
+    double totalMs;
+    double maxMs;
+};
+
+#endif
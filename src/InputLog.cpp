@@ -0,0 +1,145 @@
+#include "InputLog.h"
+#include "MappedFile.h"
+#include <fstream>
+#include <iostream>
+
+namespace {
+const uint32_t LOG_MAGIC = 0x504E4944; // "DINP" in file byte order
+const uint32_t LOG_VERSION = 1;
+
+const uint8_t FLAG_FLASH = 1;
+const uint8_t FLAG_TARGET = 2;
+
+// About ten minutes at 120 ticks per second with the mouse mostly still.
+const size_t EXPECTED_LOG_BYTES = 128 * 1024;
+}
+
+InputLog::InputLog()
+    : seed(0), mode(GameMode::CLASSIC), tickMs(0), saved(false), tickCount(0),
+      hasTarget(false), lastTargetX(0), lastTargetY(0) {}
+
+void InputLog::begin(uint64_t newSeed, GameMode newMode, float newTickMs) {
+    seed = newSeed;
+    mode = newMode;
+    tickMs = newTickMs;
+    saved = false;
+    tickCount = 0;
+    ticks.clear();
+    ticks.reserve(EXPECTED_LOG_BYTES);
+    hasTarget = false;
+    inputs.clear();
+}
+
+void InputLog::record(const SimInput& input) {
+    bool moved = !hasTarget || input.targetX != lastTargetX || input.targetY != lastTargetY;
+    uint8_t flags = (input.flash ? FLAG_FLASH : 0) | (moved ? FLAG_TARGET : 0);
+    ticks.writeBytes(&flags, 1);
+    if (moved) {
+        ticks.writeF32(input.targetX);
+        ticks.writeF32(input.targetY);
+        lastTargetX = input.targetX;
+        lastTargetY = input.targetY;
+        hasTarget = true;
+    }
+    ++tickCount;
+}
+
+void InputLog::recordSave() {
+    saved = true;
+}
+
+bool InputLog::save(const std::string& path) const {
+    SaveWriter header;
+    header.writeU32(LOG_MAGIC);
+    header.writeU32(LOG_VERSION);
+    header.writeU64(seed);
+    header.writeI32(static_cast<int32_t>(mode));
+    header.writeF32(tickMs);
+    header.writeI32(tickCount);
+    header.writeU32(saved ? 1 : 0);
+    header.writeU32(saveChecksum(ticks.getBuffer().data(), ticks.size()));
+
+    std::ofstream outFile(path, std::ios::binary | std::ios::trunc);
+    const std::vector<uint8_t>& headerBytes = header.getBuffer();
+    const std::vector<uint8_t>& tickBytes = ticks.getBuffer();
+    if (!outFile ||
+        !outFile.write(reinterpret_cast<const char*>(headerBytes.data()), headerBytes.size()) ||
+        !outFile.write(reinterpret_cast<const char*>(tickBytes.data()), tickBytes.size())) {
+        std::cerr << "Failed to write input log " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool InputLog::load(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Input log not found: " << path << std::endl;
+        return false;
+    }
+    SaveReader reader(file.data(), file.size());
+    if (reader.readU32() != LOG_MAGIC || reader.readU32() != LOG_VERSION) {
+        std::cerr << "Not an input log (or unsupported version): " << path << std::endl;
+        return false;
+    }
+    uint64_t savedSeed = reader.readU64();
+    int32_t savedMode = reader.readI32();
+    float savedTickMs = reader.readF32();
+    int32_t savedTicks = reader.readI32();
+    bool savedExit = reader.readU32() != 0;
+    uint32_t checksum = reader.readU32();
+    const uint8_t* tickData = file.data() + (file.size() - reader.remaining());
+    size_t tickBytes = reader.remaining();
+    if (reader.failed() || savedMode < 0 || savedMode >= GAME_MODE_COUNT ||
+        savedTicks < 0 || !(savedTickMs > 0) || saveChecksum(tickData, tickBytes) != checksum) {
+        std::cerr << "Input log is corrupt: " << path << std::endl;
+        return false;
+    }
+
+    begin(savedSeed, static_cast<GameMode>(savedMode), savedTickMs);
+    saved = savedExit;
+    inputs.reserve(savedTicks);
+    SimInput input = {0, 0, false};
+    for (int i = 0; i < savedTicks; ++i) {
+        uint8_t flags = 0;
+        reader.readBytes(&flags, 1);
+        if (flags & FLAG_TARGET) {
+            input.targetX = reader.readF32();
+            input.targetY = reader.readF32();
+        }
+        input.flash = (flags & FLAG_FLASH) != 0;
+        inputs.push_back(input);
+    }
+    if (reader.failed() || reader.remaining() != 0) {
+        std::cerr << "Input log is corrupt: " << path << std::endl;
+        inputs.clear();
+        return false;
+    }
+    tickCount = savedTicks;
+    ticks.writeBytes(tickData, tickBytes);
+    return true;
+}
+
+uint64_t InputLog::getSeed() const {
+    return seed;
+}
+
+GameMode InputLog::getMode() const {
+    return mode;
+}
+
+float InputLog::getTickMs() const {
+    return tickMs;
+}
+
+const std::vector<SimInput>& InputLog::getInputs() const {
+    return inputs;
+}
+
+bool InputLog::endedWithSave() const {
+    return saved;
+}
+
+int InputLog::getTickCount() const {
+    return tickCount;
+}
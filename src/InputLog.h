@@ -0,0 +1,46 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SaveFile.h"
+#include "Simulation.h"
+
+// Per-tick record of what a game fed into Simulation::step, plus the seed and
+// mode it started from, so the game can be re-simulated exactly. Each tick is
+// one flags byte, followed by the target only when it changed since the
+// previous tick.
+class InputLog {
+public:
+    InputLog();
+    // Starts a new log; the game must have been seeded with `seed` and reset to `mode`.
+    void begin(uint64_t seed, GameMode mode, float tickMs);
+    void record(const SimInput& input);
+    // The player saved and left after the last recorded tick.
+    void recordSave();
+
+    bool save(const std::string& path) const;
+    // Decodes the whole log into getInputs().
+    bool load(const std::string& path);
+
+    uint64_t getSeed() const;
+    GameMode getMode() const;
+    float getTickMs() const;
+    const std::vector<SimInput>& getInputs() const;
+    bool endedWithSave() const;
+    int getTickCount() const;
+
+private:
+    uint64_t seed;
+    GameMode mode;
+    float tickMs;
+    bool saved;
+    int tickCount;
+    SaveWriter ticks;
+    bool hasTarget;
+    float lastTargetX, lastTargetY;
+    std::vector<SimInput> inputs;
+};
+
+#endif
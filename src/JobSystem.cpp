@@ -0,0 +1,149 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+uint64_t microsSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+}
+
+JobSystem::JobSystem(int requestedThreads)
+    : threadCount(requestedThreads), generation(0), activeWorkers(0), stopping(false),
+      function(nullptr), context(nullptr), count(0), chunkSize(1), batches(0),
+      windowStart(Clock::now()), windowBusyMicros(0), utilisation(0) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    slots.reset(new Slot[threadCount]);
+    for (int t = 0; t < threadCount; ++t) {
+        slots[t].next.store(0);
+        slots[t].end = 0;
+        slots[t].busyMicros.store(0);
+        slots[t].chunks.store(0);
+        slots[t].stolen.store(0);
+    }
+    for (int t = 1; t < threadCount; ++t) {
+        workers.emplace_back(&JobSystem::workerMain, this, t);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int JobSystem::getThreadCount() const {
+    return threadCount;
+}
+
+int JobSystem::getChunkCount(int count, int chunkSize) {
+    return count <= 0 ? 0 : (count + chunkSize - 1) / chunkSize;
+}
+
+void JobSystem::run(int itemCount, int itemsPerChunk, ChunkFunction chunkFunction, void* chunkContext) {
+    itemsPerChunk = std::max(itemsPerChunk, 1);
+    int chunks = getChunkCount(itemCount, itemsPerChunk);
+    if (chunks == 0) {
+        return;
+    }
+    // Inline runs are plain calls on the caller and stay out of the stats.
+    if (chunks == 1 || threadCount == 1) {
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            chunkFunction(chunkContext, chunk, chunk * itemsPerChunk, std::min(itemCount, (chunk + 1) * itemsPerChunk));
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        function = chunkFunction;
+        context = chunkContext;
+        count = itemCount;
+        chunkSize = itemsPerChunk;
+        for (int t = 0; t < threadCount; ++t) {
+            slots[t].next.store(static_cast<int>(static_cast<int64_t>(chunks) * t / threadCount), std::memory_order_relaxed);
+            slots[t].end = static_cast<int>(static_cast<int64_t>(chunks) * (t + 1) / threadCount);
+        }
+        activeWorkers = threadCount - 1;
+        ++generation;
+    }
+    wakeCondition.notify_all();
+    batches.fetch_add(1, std::memory_order_relaxed);
+
+    runChunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+}
+
+void JobSystem::runChunks(int thread) {
+    Clock::time_point start = Clock::now();
+    uint64_t ran = 0;
+    uint64_t stolen = 0;
+    // Own run first, then the others' in order starting after this one.
+    for (int offset = 0; offset < threadCount; ++offset) {
+        Slot& slot = slots[(thread + offset) % threadCount];
+        for (;;) {
+            int chunk = slot.next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= slot.end) {
+                break;
+            }
+            function(context, chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+            ++ran;
+            if (offset > 0) ++stolen;
+        }
+    }
+    Slot& own = slots[thread];
+    own.busyMicros.fetch_add(microsSince(start), std::memory_order_relaxed);
+    own.chunks.fetch_add(ran, std::memory_order_relaxed);
+    own.stolen.fetch_add(stolen, std::memory_order_relaxed);
+}
+
+void JobSystem::workerMain(int thread) {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+        runChunks(thread);
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last = --activeWorkers == 0;
+        }
+        if (last) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+JobStats JobSystem::getStats() {
+    JobStats stats = {threadCount, batches.load(std::memory_order_relaxed), 0, 0, 0};
+    uint64_t busyMicros = 0;
+    for (int t = 0; t < threadCount; ++t) {
+        busyMicros += slots[t].busyMicros.load(std::memory_order_relaxed);
+        stats.chunks += slots[t].chunks.load(std::memory_order_relaxed);
+        stats.stolenChunks += slots[t].stolen.load(std::memory_order_relaxed);
+    }
+    uint64_t windowMicros = microsSince(windowStart);
+    if (windowMicros >= STATS_WINDOW_MS * 1000ull) {
+        utilisation = static_cast<double>(busyMicros - windowBusyMicros) / (static_cast<double>(windowMicros) * threadCount);
+        windowStart = Clock::now();
+        windowBusyMicros = busyMicros;
+    }
+    stats.utilisation = utilisation;
+    return stats;
+}
@@ -0,0 +1,93 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct JobStats {
+    int threadCount;          // workers plus the calling thread
+    uint64_t batches;         // parallelFor calls that were spread over threads
+    uint64_t chunks;          // run by those batches
+    uint64_t stolenChunks;    // run by a thread other than their owner
+    double utilisation;       // busy share of all threads over the last stats window
+};
+
+// Small fork-join pool for data-parallel loops. parallelFor splits [0, count)
+// into chunks and gives each thread a contiguous run of them; a thread that
+// finishes its own run steals the remaining chunks of the others. The calling
+// thread takes part, and the call returns once every chunk is done.
+//
+// parallelFor must only be called from one thread at a time and not from
+// inside a chunk.
+class JobSystem {
+public:
+    // threadCount includes the calling thread; 0 uses every hardware thread.
+    explicit JobSystem(int threadCount = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int getThreadCount() const;
+    static int getChunkCount(int count, int chunkSize);
+
+    // Calls body(chunk, begin, end) for every chunk of [0, count). Runs inline
+    // when there is only one chunk or one thread.
+    template <typename F>
+    void parallelFor(int count, int chunkSize, F&& body) {
+        typedef typename std::remove_reference<F>::type Body;
+        run(count, chunkSize, [](void* context, int chunk, int begin, int end) {
+            (*static_cast<Body*>(context))(chunk, begin, end);
+        }, const_cast<void*>(static_cast<const void*>(&body)));
+    }
+
+    // Totals since construction; utilisation is refreshed at most every
+    // STATS_WINDOW_MS. Safe to call from any one thread while jobs run.
+    JobStats getStats();
+
+private:
+    typedef void (*ChunkFunction)(void* context, int chunk, int begin, int end);
+    static const int STATS_WINDOW_MS = 500;
+
+    // One per thread (index 0 is the caller): its run of chunks and counters.
+    struct alignas(64) Slot {
+        std::atomic<int> next;
+        int end;
+        std::atomic<uint64_t> busyMicros;
+        std::atomic<uint64_t> chunks;
+        std::atomic<uint64_t> stolen;
+    };
+
+    int threadCount;
+    std::unique_ptr<Slot[]> slots;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    uint64_t generation;
+    int activeWorkers;
+    bool stopping;
+
+    // The batch in flight; written under the mutex before workers are woken.
+    ChunkFunction function;
+    void* context;
+    int count;
+    int chunkSize;
+
+    std::atomic<uint64_t> batches;
+    std::chrono::steady_clock::time_point windowStart;
+    uint64_t windowBusyMicros;
+    double utilisation;
+
+    void run(int count, int chunkSize, ChunkFunction function, void* context);
+    void runChunks(int thread);
+    void workerMain(int thread);
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "LinkSimulator.h"
+#include <cstring>
+
+LinkSimulator::LinkSimulator(uint64_t seed)
+    : random(seed, 0), lossPercent(0), latencyMs(0), jitterMs(0), queued(0), dropped(0) {}
+
+void LinkSimulator::setConditions(float loss, float latency, float jitter) {
+    lossPercent = loss;
+    latencyMs = latency;
+    jitterMs = jitter;
+}
+
+bool LinkSimulator::isPerfect() const {
+    return lossPercent <= 0 && latencyMs <= 0 && jitterMs <= 0;
+}
+
+bool LinkSimulator::submit(const NetAddress& to, const uint8_t* data, size_t size, double nowMs) {
+    // Hundredths of a percent are enough resolution for the knob.
+    bool lost = lossPercent > 0 && random.nextInt(10000) < static_cast<int>(lossPercent * 100);
+    if (lost || size > MAX_PACKET_SIZE || queued == CAPACITY) {
+        ++dropped;
+        return false;
+    }
+    Packet& packet = queue[queued++];
+    packet.to = to;
+    packet.dueMs = nowMs + latencyMs;
+    if (jitterMs > 0) {
+        packet.dueMs += jitterMs * (random.nextInt(2001) - 1000) / 1000.0;
+    }
+    packet.size = size;
+    std::memcpy(packet.data, data, size);
+    return true;
+}
+
+// A linear scan is fine at a few hundred packets in flight.
+bool LinkSimulator::release(double nowMs, Packet& packet) {
+    int earliest = -1;
+    for (int i = 0; i < queued; ++i) {
+        if (queue[i].dueMs <= nowMs && (earliest < 0 || queue[i].dueMs < queue[earliest].dueMs)) {
+            earliest = i;
+        }
+    }
+    if (earliest < 0) {
+        return false;
+    }
+    packet = queue[earliest];
+    queue[earliest] = queue[--queued];
+    return true;
+}
+
+uint64_t LinkSimulator::getDroppedCount() const {
+    return dropped;
+}
@@ -0,0 +1,48 @@
+#ifndef LINK_SIMULATOR_H
+#define LINK_SIMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Random.h"
+#include "UdpSocket.h"
+
+// Stands in for a bad network on the way out: drops a share of the packets
+// it is given and holds the rest back for a latency plus random jitter
+// (which can reorder them). Time is whatever the caller counts in ms, so the
+// same link works on the wall clock and in simulated time, and a seed
+// repeats the same losses.
+class LinkSimulator {
+public:
+    static const size_t MAX_PACKET_SIZE = 64;
+    static const int CAPACITY = 256;
+
+    struct Packet {
+        NetAddress to;
+        double dueMs;
+        size_t size;
+        uint8_t data[MAX_PACKET_SIZE];
+    };
+
+    explicit LinkSimulator(uint64_t seed = 1);
+    void setConditions(float lossPercent, float latencyMs, float jitterMs);
+    // Nothing is lost or delayed; packets still go through the queue.
+    bool isPerfect() const;
+
+    // False if the packet was lost, too large or the link is full.
+    bool submit(const NetAddress& to, const uint8_t* data, size_t size, double nowMs);
+    // Takes out one packet whose time has come; false when none is due.
+    bool release(double nowMs, Packet& packet);
+
+    uint64_t getDroppedCount() const;
+
+private:
+    Random random;
+    float lossPercent;
+    float latencyMs;
+    float jitterMs;
+    Packet queue[CAPACITY];
+    int queued;
+    uint64_t dropped;
+};
+
+#endif
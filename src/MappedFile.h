@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap, or a file mapping on
+// Windows). The view stays valid until close() or destruction.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    const uint8_t* data() const;
+    size_t size() const;
+
+private:
+    const uint8_t* view;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "ObstaclePool.h"
+#include "Constants.h"
+#include "JobSystem.h"
+#include "SaveFile.h"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Obstacles spawn exactly on these bounds, and the simulation backs a new one
+// off by the part of the step before it was due; the margin keeps rounding in
+// that round trip from culling it on arrival.
+const float CULL_MARGIN = 1.0f;
+const float CULL_MIN_X = -OBJECT_SIZE - CULL_MARGIN;
+const float CULL_MAX_X = WINDOW_WIDTH + CULL_MARGIN;
+const float CULL_MIN_Y = -OBJECT_SIZE - CULL_MARGIN;
+const float CULL_MAX_Y = WINDOW_HEIGHT + CULL_MARGIN;
+// Large enough that normal games (a few hundred obstacles) never leave the
+// calling thread; a multiple of 8 so chunks start on SIMD boundaries.
+const int PARALLEL_CHUNK = 8192;
+}
+
+ObstaclePool::ObstaclePool(int capacity)
+    : xs(capacity), ys(capacity), dxs(capacity), dys(capacity), count(0) {
+    culled.reserve(capacity);
+}
+
+bool ObstaclePool::add(const GameObject& obj) {
+    if (count == capacity()) {
+        return false;
+    }
+    xs[count] = obj.x;
+    ys[count] = obj.y;
+    dxs[count] = obj.dx;
+    dys[count] = obj.dy;
+    ++count;
+    return true;
+}
+
+void ObstaclePool::removeAt(int index) {
+    --count;
+    xs[index] = xs[count];
+    ys[index] = ys[count];
+    dxs[index] = dxs[count];
+    dys[index] = dys[count];
+}
+
+void ObstaclePool::clear() {
+    count = 0;
+}
+
+bool ObstaclePool::integrate(float frames, const SweptRect& player) {
+    culled.clear();
+    bool hit = integrateRange(0, count, frames, player, culled);
+    removeCulled(culled);
+    return hit;
+}
+
+bool ObstaclePool::integrate(JobSystem& jobs, float frames, const SweptRect& player) {
+    int chunks = JobSystem::getChunkCount(count, PARALLEL_CHUNK);
+    if (chunks <= 1) {
+        return integrate(frames, player);
+    }
+    while (static_cast<int>(chunkCulled.size()) < chunks) {
+        chunkCulled.emplace_back();
+        chunkCulled.back().reserve(PARALLEL_CHUNK);
+    }
+    chunkHits.resize(chunks);
+    jobs.parallelFor(count, PARALLEL_CHUNK, [&](int chunk, int begin, int end) {
+        chunkCulled[chunk].clear();
+        chunkHits[chunk] = integrateRange(begin, end, frames, player, chunkCulled[chunk]);
+    });
+
+    // Chunks are in index order, so walking them back to front removes in
+    // the same order as the single-threaded path.
+    bool hit = false;
+    for (int chunk = chunks - 1; chunk >= 0; --chunk) {
+        hit |= chunkHits[chunk] != 0;
+        removeCulled(chunkCulled[chunk]);
+    }
+    return hit;
+}
+
+bool ObstaclePool::integrateRange(int begin, int end, float frames, const SweptRect& player, std::vector<int>& culledOut) {
+    float* x = xs.data();
+    float* y = ys.data();
+    const float* dx = dxs.data();
+    const float* dy = dys.data();
+    // Broad phase: the box covering the player's whole path this step against
+    // the box covering each obstacle's. Only the rare overlaps get the exact
+    // swept test, so nothing can pass through the player between samples.
+    const float boxMinX = std::min(player.x0, player.x1);
+    const float boxMaxX = std::max(player.x0, player.x1) + player.w;
+    const float boxMinY = std::min(player.y0, player.y1);
+    const float boxMaxY = std::max(player.y0, player.y1) + player.h;
+    bool hit = false;
+    int i = begin;
+    auto sweptHit = [&](int index) {
+        float moveX = dx[index] * frames;
+        float moveY = dy[index] * frames;
+        SweptRect obstacle = {x[index] - moveX, y[index] - moveY, x[index], y[index], OBJECT_SIZE, OBJECT_SIZE};
+        return sweptCollisionTime(player, obstacle) >= 0.0f;
+    };
+
+#if defined(__AVX2__)
+    const __m256 vFrames = _mm256_set1_ps(frames);
+    const __m256 vSize = _mm256_set1_ps(OBJECT_SIZE);
+    const __m256 vMinX = _mm256_set1_ps(CULL_MIN_X), vMaxX = _mm256_set1_ps(CULL_MAX_X);
+    const __m256 vMinY = _mm256_set1_ps(CULL_MIN_Y), vMaxY = _mm256_set1_ps(CULL_MAX_Y);
+    const __m256 vBoxMinX = _mm256_set1_ps(boxMinX), vBoxMaxX = _mm256_set1_ps(boxMaxX);
+    const __m256 vBoxMinY = _mm256_set1_ps(boxMinY), vBoxMaxY = _mm256_set1_ps(boxMaxY);
+    for (; i + 8 <= end; i += 8) {
+        __m256 ox = _mm256_loadu_ps(x + i);
+        __m256 oy = _mm256_loadu_ps(y + i);
+        __m256 px = _mm256_add_ps(ox, _mm256_mul_ps(_mm256_loadu_ps(dx + i), vFrames));
+        __m256 py = _mm256_add_ps(oy, _mm256_mul_ps(_mm256_loadu_ps(dy + i), vFrames));
+        _mm256_storeu_ps(x + i, px);
+        _mm256_storeu_ps(y + i, py);
+
+        __m256 out = _mm256_or_ps(
+            _mm256_or_ps(_mm256_cmp_ps(px, vMinX, _CMP_LT_OQ), _mm256_cmp_ps(px, vMaxX, _CMP_GT_OQ)),
+            _mm256_or_ps(_mm256_cmp_ps(py, vMinY, _CMP_LT_OQ), _mm256_cmp_ps(py, vMaxY, _CMP_GT_OQ)));
+        __m256 overlap = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(vBoxMinX, _mm256_add_ps(_mm256_max_ps(ox, px), vSize), _CMP_LT_OQ),
+                          _mm256_cmp_ps(vBoxMaxX, _mm256_min_ps(ox, px), _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(vBoxMinY, _mm256_add_ps(_mm256_max_ps(oy, py), vSize), _CMP_LT_OQ),
+                          _mm256_cmp_ps(vBoxMaxY, _mm256_min_ps(oy, py), _CMP_GT_OQ)));
+        int overlapMask = _mm256_movemask_ps(overlap);
+        while (overlapMask && !hit) {
+            hit = sweptHit(i + __builtin_ctz(overlapMask));
+            overlapMask &= overlapMask - 1;
+        }
+        int outMask = _mm256_movemask_ps(out);
+        while (outMask) {
+            culledOut.push_back(i + __builtin_ctz(outMask));
+            outMask &= outMask - 1;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128 vFrames = _mm_set1_ps(frames);
+    const __m128 vSize = _mm_set1_ps(OBJECT_SIZE);
+    const __m128 vMinX = _mm_set1_ps(CULL_MIN_X), vMaxX = _mm_set1_ps(CULL_MAX_X);
+    const __m128 vMinY = _mm_set1_ps(CULL_MIN_Y), vMaxY = _mm_set1_ps(CULL_MAX_Y);
+    const __m128 vBoxMinX = _mm_set1_ps(boxMinX), vBoxMaxX = _mm_set1_ps(boxMaxX);
+    const __m128 vBoxMinY = _mm_set1_ps(boxMinY), vBoxMaxY = _mm_set1_ps(boxMaxY);
+    for (; i + 4 <= end; i += 4) {
+        __m128 ox = _mm_loadu_ps(x + i);
+        __m128 oy = _mm_loadu_ps(y + i);
+        __m128 px = _mm_add_ps(ox, _mm_mul_ps(_mm_loadu_ps(dx + i), vFrames));
+        __m128 py = _mm_add_ps(oy, _mm_mul_ps(_mm_loadu_ps(dy + i), vFrames));
+        _mm_storeu_ps(x + i, px);
+        _mm_storeu_ps(y + i, py);
+
+        __m128 out = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(px, vMinX), _mm_cmpgt_ps(px, vMaxX)),
+                               _mm_or_ps(_mm_cmplt_ps(py, vMinY), _mm_cmpgt_ps(py, vMaxY)));
+        __m128 overlap = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(vBoxMinX, _mm_add_ps(_mm_max_ps(ox, px), vSize)), _mm_cmpgt_ps(vBoxMaxX, _mm_min_ps(ox, px))),
+            _mm_and_ps(_mm_cmplt_ps(vBoxMinY, _mm_add_ps(_mm_max_ps(oy, py), vSize)), _mm_cmpgt_ps(vBoxMaxY, _mm_min_ps(oy, py))));
+        int overlapMask = _mm_movemask_ps(overlap);
+        while (overlapMask && !hit) {
+            hit = sweptHit(i + __builtin_ctz(overlapMask));
+            overlapMask &= overlapMask - 1;
+        }
+        int outMask = _mm_movemask_ps(out);
+        while (outMask) {
+            culledOut.push_back(i + __builtin_ctz(outMask));
+            outMask &= outMask - 1;
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+        float ox = x[i];
+        float oy = y[i];
+        x[i] += dx[i] * frames;
+        y[i] += dy[i] * frames;
+        if (!hit && boxMinX < std::max(ox, x[i]) + OBJECT_SIZE && boxMaxX > std::min(ox, x[i]) &&
+            boxMinY < std::max(oy, y[i]) + OBJECT_SIZE && boxMaxY > std::min(oy, y[i])) {
+            hit = sweptHit(i);
+        }
+        if (x[i] < CULL_MIN_X || x[i] > CULL_MAX_X || y[i] < CULL_MIN_Y || y[i] > CULL_MAX_Y) {
+            culledOut.push_back(i);
+        }
+    }
+    return hit;
+}
+
+void ObstaclePool::removeCulled(const std::vector<int>& indices) {
+    // Indices are ascending, so removing from the back means every element
+    // swapped into a hole is one that survived.
+    for (auto it = indices.rbegin(); it != indices.rend(); ++it) {
+        removeAt(*it);
+    }
+}
+
+void ObstaclePool::save(SaveWriter& writer) const {
+    writer.writeI32(count);
+    writer.writeFloats(xs.data(), count);
+    writer.writeFloats(ys.data(), count);
+    writer.writeFloats(dxs.data(), count);
+    writer.writeFloats(dys.data(), count);
+}
+
+bool ObstaclePool::load(SaveReader& reader) {
+    int savedCount = reader.readI32();
+    if (savedCount < 0 || savedCount > capacity() ||
+        reader.remaining() < static_cast<size_t>(savedCount) * 4 * sizeof(float)) {
+        count = 0;
+        return false;
+    }
+    reader.readFloats(xs.data(), savedCount);
+    reader.readFloats(ys.data(), savedCount);
+    reader.readFloats(dxs.data(), savedCount);
+    reader.readFloats(dys.data(), savedCount);
+    count = savedCount;
+    return !reader.failed();
+}
+
+int ObstaclePool::size() const {
+    return count;
+}
+
+int ObstaclePool::capacity() const {
+    return static_cast<int>(xs.size());
+}
+
+GameObject ObstaclePool::get(int index) const {
+    GameObject obj;
+    obj.x = xs[index];
+    obj.y = ys[index];
+    obj.dx = dxs[index];
+    obj.dy = dys[index];
+    return obj;
+}
+
+const float* ObstaclePool::getX() const {
+    return xs.data();
+}
+
+const float* ObstaclePool::getY() const {
+    return ys.data();
+}
+
+const float* ObstaclePool::getDX() const {
+    return dxs.data();
+}
+
+const float* ObstaclePool::getDY() const {
+    return dys.data();
+}
@@ -0,0 +1,62 @@
+#ifndef OBSTACLE_POOL_H
+#define OBSTACLE_POOL_H
+
+#include <vector>
+#include "Collision.h"
+#include "GameObject.h"
+
+class JobSystem;
+class SaveReader;
+class SaveWriter;
+
+// Fixed-capacity obstacle storage as separate x/y/dx/dy arrays. Removal is
+// swap-and-pop (order is not preserved) and nothing is reallocated after
+// construction.
+class ObstaclePool {
+public:
+    explicit ObstaclePool(int capacity);
+    // Returns false (and drops the obstacle) when the pool is full.
+    bool add(const GameObject& obj);
+    void removeAt(int index);
+    void clear();
+
+    // Moves every obstacle by (dx, dy) * frames, removes the ones that left the
+    // playfield and reports whether any of them touched the player at any
+    // point of the step (swept test, so fast obstacles cannot tunnel).
+    // Uses AVX2 or SSE2 when compiled for them, with a scalar tail/fallback.
+    bool integrate(float frames, const SweptRect& player);
+    // Same result (including the order of the survivors), with the array
+    // split into chunks that are integrated, culled and tested on the job
+    // system. Each chunk reports its own hit flag and culled indices; they are
+    // combined on the calling thread.
+    bool integrate(JobSystem& jobs, float frames, const SweptRect& player);
+
+    // Count followed by the four coordinate arrays; load() copies them
+    // straight into the pool and fails if they do not fit.
+    void save(SaveWriter& writer) const;
+    bool load(SaveReader& reader);
+
+    int size() const;
+    int capacity() const;
+    GameObject get(int index) const;
+    const float* getX() const;
+    const float* getY() const;
+    const float* getDX() const;
+    const float* getDY() const;
+
+private:
+    std::vector<float> xs, ys, dxs, dys;
+    std::vector<int> culled;
+    // Per-chunk results of the parallel integrate, grown on demand.
+    std::vector<std::vector<int>> chunkCulled;
+    std::vector<char> chunkHits;
+    int count;
+
+    // Integrates [begin, end), appends the culled indices (ascending) and
+    // reports whether an obstacle touched the player during the step.
+    bool integrateRange(int begin, int end, float frames, const SweptRect& player, std::vector<int>& culledOut);
+    // Swap-and-pop removal of ascending indices, last first.
+    void removeCulled(const std::vector<int>& indices);
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "PackFile.h"
+#include "SaveFile.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+const uint32_t PACK_MAGIC = 0x4B415044; // "DPAK" in file byte order
+const uint32_t PACK_VERSION = 2; // 2: the checksum covers the header too
+const size_t HEADER_SIZE = 16;
+const size_t NAME_SIZE = 32;
+const size_t DIRECTORY_ENTRY_SIZE = NAME_SIZE + 6 * 4;
+const size_t DATA_ALIGNMENT = 16;
+
+size_t alignUp(size_t value) {
+    return (value + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+}
+
+// Everything but the checksum field itself (the last header word).
+uint32_t packChecksum(const uint8_t* data, size_t size) {
+    return saveChecksum(data, HEADER_SIZE - 4) ^ saveChecksum(data + HEADER_SIZE, size - HEADER_SIZE);
+}
+}
+
+bool PackFile::open(const std::string& path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+    SaveReader header(file.data(), file.size());
+    uint32_t magic = header.readU32();
+    uint32_t version = header.readU32();
+    uint32_t count = header.readU32();
+    uint32_t checksum = header.readU32();
+    if (header.failed() || magic != PACK_MAGIC || version != PACK_VERSION) {
+        std::cerr << path << " is not an asset pack (or has an unsupported version)" << std::endl;
+        close();
+        return false;
+    }
+    // A bad count would otherwise size the directory before anything catches it.
+    if (count > (file.size() - HEADER_SIZE) / DIRECTORY_ENTRY_SIZE ||
+        packChecksum(file.data(), file.size()) != checksum) {
+        std::cerr << "Asset pack " << path << " is corrupt!" << std::endl;
+        close();
+        return false;
+    }
+
+    SaveReader directory(file.data() + HEADER_SIZE, file.size() - HEADER_SIZE);
+    entries.resize(count);
+    for (PackEntry& entry : entries) {
+        char name[NAME_SIZE + 1] = {};
+        directory.readBytes(name, NAME_SIZE);
+        entry.name = name;
+        entry.type = static_cast<PackEntryType>(directory.readU32());
+        for (uint32_t& param : entry.params) {
+            param = directory.readU32();
+        }
+        uint32_t offset = directory.readU32();
+        entry.size = directory.readU32();
+        if (directory.failed() || offset > file.size() || entry.size > file.size() - offset) {
+            std::cerr << "Asset pack " << path << " is corrupt!" << std::endl;
+            close();
+            return false;
+        }
+        entry.data = file.data() + offset;
+    }
+    return true;
+}
+
+void PackFile::close() {
+    entries.clear();
+    file.close();
+}
+
+const PackEntry* PackFile::find(const std::string& name) const {
+    for (const PackEntry& entry : entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const std::vector<PackEntry>& PackFile::getEntries() const {
+    return entries;
+}
+
+void PackWriter::add(const std::string& name, PackEntryType type, const void* data, size_t size,
+                     uint32_t param0, uint32_t param1, uint32_t param2) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    pending.push_back({name, type, {param0, param1, param2}, std::vector<uint8_t>(bytes, bytes + size)});
+}
+
+bool PackWriter::write(const std::string& path) const {
+    SaveWriter writer;
+    writer.writeU32(PACK_MAGIC);
+    writer.writeU32(PACK_VERSION);
+    writer.writeU32(static_cast<uint32_t>(pending.size()));
+    writer.writeU32(0); // checksum, patched below
+
+    size_t offset = alignUp(HEADER_SIZE + pending.size() * DIRECTORY_ENTRY_SIZE);
+    for (const Pending& entry : pending) {
+        if (entry.name.size() >= NAME_SIZE) {
+            std::cerr << "Pack entry name too long: " << entry.name << std::endl;
+            return false;
+        }
+        char name[NAME_SIZE] = {};
+        std::memcpy(name, entry.name.data(), entry.name.size());
+        writer.writeBytes(name, NAME_SIZE);
+        writer.writeU32(static_cast<uint32_t>(entry.type));
+        for (uint32_t param : entry.params) {
+            writer.writeU32(param);
+        }
+        writer.writeU32(static_cast<uint32_t>(offset));
+        writer.writeU32(static_cast<uint32_t>(entry.data.size()));
+        offset = alignUp(offset + entry.data.size());
+    }
+    const uint8_t zeros[DATA_ALIGNMENT] = {};
+    for (const Pending& entry : pending) {
+        writer.writeBytes(zeros, alignUp(writer.size()) - writer.size());
+        writer.writeBytes(entry.data.data(), entry.data.size());
+    }
+    const std::vector<uint8_t>& buffer = writer.getBuffer();
+    writer.patchU32(HEADER_SIZE - 4, packChecksum(buffer.data(), buffer.size()));
+
+    std::ofstream outFile(path, std::ios::binary | std::ios::trunc);
+    if (!outFile || !outFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size())) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef PACK_FILE_H
+#define PACK_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+enum class PackEntryType : uint32_t {
+    TEXTURE = 1, // params: width, height; RGBA32 pixels, tightly packed rows
+    SOUND = 2,   // params: frequency, SDL audio format, channels; raw samples
+    MUSIC = 3,   // the original encoded file; the game decodes it to PCM at startup
+    FONT = 4     // params: width, height, glyph count; int32 metrics then RGBA32 pixels
+};
+
+struct PackEntry {
+    std::string name;
+    PackEntryType type;
+    uint32_t params[3];
+    const uint8_t* data;
+    uint32_t size;
+};
+
+// Single-file asset archive produced by dodge_pack. Layout (little-endian):
+// a 16-byte header (magic "DPAK", version, entry count, checksum of every
+// other byte of the file), a directory of fixed-size entries, then each
+// entry's data 16-byte aligned.
+// The file stays mapped while open and entry data points into the mapping.
+class PackFile {
+public:
+    bool open(const std::string& path);
+    void close();
+    const PackEntry* find(const std::string& name) const;
+    const std::vector<PackEntry>& getEntries() const;
+
+private:
+    MappedFile file;
+    std::vector<PackEntry> entries;
+};
+
+// Collects entries in memory and writes them out in one go.
+class PackWriter {
+public:
+    void add(const std::string& name, PackEntryType type, const void* data, size_t size,
+             uint32_t param0 = 0, uint32_t param1 = 0, uint32_t param2 = 0);
+    bool write(const std::string& path) const;
+
+private:
+    struct Pending {
+        std::string name;
+        PackEntryType type;
+        uint32_t params[3];
+        std::vector<uint8_t> data;
+    };
+    std::vector<Pending> pending;
+};
+
+#endif
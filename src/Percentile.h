@@ -0,0 +1,13 @@
+#ifndef PERCENTILE_H
+#define PERCENTILE_H
+
+#include <algorithm>
+#include <vector>
+
+// Nearest-rank percentile (p in 0..100) of sorted, non-empty values.
+inline double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+#endif
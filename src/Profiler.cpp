@@ -0,0 +1,174 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+// About 24 minutes of play: 4 phases a frame at 60 FPS plus 4 a tick from the
+// simulation thread at 120 Hz is ~720 events a second. Later events are
+// dropped. At 24 bytes an event this is a 24 MB buffer at most.
+const size_t MAX_TRACE_EVENTS = 1 << 20;
+
+uint64_t steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+Profiler::Profiler()
+    : enabled(false), tracing(false), threadId(1), origin(steadyMicros()), lastFrameEnd(0), currentFrame(),
+      sampleCursor(0), sampleCount(0), obstacleCount(0) {
+    for (auto& window : samples) {
+        window.assign(WINDOW_FRAMES, 0);
+    }
+    sortScratch.reserve(WINDOW_FRAMES);
+}
+
+void Profiler::setEnabled(bool enable) {
+    enabled = enable;
+    sampleCursor = 0;
+    sampleCount = 0;
+    std::fill(currentFrame, currentFrame + PROFILE_PHASE_COUNT, 0);
+    lastFrameEnd = now();
+}
+
+bool Profiler::isEnabled() const {
+    return enabled;
+}
+
+bool Profiler::isActive() const {
+    return enabled || tracing;
+}
+
+void Profiler::startTrace(const std::string& path) {
+    tracePath = path;
+    traceEvents.clear();
+    traceEvents.reserve(4096);
+    tracing = true;
+}
+
+bool Profiler::stopTrace() {
+    if (!tracing) {
+        return false;
+    }
+    tracing = false;
+    std::ofstream outFile(tracePath);
+    if (!outFile) {
+        std::cerr << "Failed to write trace file " << tracePath << std::endl;
+        return false;
+    }
+    outFile << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < traceEvents.size(); ++i) {
+        const TraceEvent& event = traceEvents[i];
+        outFile << "{\"name\":\"" << getPhaseName(event.phase) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+                << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}"
+                << (i + 1 < traceEvents.size() ? ",\n" : "\n");
+    }
+    outFile << "],\"displayTimeUnit\":\"ms\"}\n";
+    traceEvents.clear();
+    traceEvents.shrink_to_fit();
+    return true;
+}
+
+void Profiler::setThreadId(int id) {
+    threadId = id;
+}
+
+void Profiler::mergeTrace(const Profiler& other) {
+    if (!tracing) {
+        return;
+    }
+    for (const TraceEvent& event : other.traceEvents) {
+        if (traceEvents.size() >= MAX_TRACE_EVENTS) {
+            break;
+        }
+        TraceEvent shifted = event;
+        shifted.start = event.start + other.origin - origin;
+        traceEvents.push_back(shifted);
+    }
+}
+
+uint64_t Profiler::now() const {
+    return steadyMicros() - origin;
+}
+
+void Profiler::record(ProfilePhase phase, uint64_t start, uint64_t end) {
+    currentFrame[phase] += end - start;
+    if (tracing && traceEvents.size() < MAX_TRACE_EVENTS) {
+        traceEvents.push_back({start, end - start, phase, threadId});
+    }
+}
+
+void Profiler::addTime(ProfilePhase phase, uint64_t micros) {
+    currentFrame[phase] += micros;
+}
+
+uint64_t Profiler::getCurrentFrameTime(ProfilePhase phase) const {
+    return currentFrame[phase];
+}
+
+void Profiler::endFrame(int obstacles) {
+    if (!enabled) {
+        return;
+    }
+    uint64_t frameEnd = now();
+    for (int p = 0; p < PROFILE_PHASE_COUNT; ++p) {
+        samples[p][sampleCursor] = static_cast<uint32_t>(currentFrame[p]);
+        currentFrame[p] = 0;
+    }
+    samples[PROFILE_PHASE_COUNT][sampleCursor] = static_cast<uint32_t>(frameEnd - lastFrameEnd);
+    lastFrameEnd = frameEnd;
+    sampleCursor = (sampleCursor + 1) % WINDOW_FRAMES;
+    sampleCount = std::min(sampleCount + 1, WINDOW_FRAMES);
+    obstacleCount = obstacles;
+}
+
+ProfileStats Profiler::computeStats(const std::vector<uint32_t>& window) const {
+    ProfileStats stats = {0, 0, 0, 0, 0};
+    if (sampleCount == 0) {
+        return stats;
+    }
+    sortScratch.assign(window.begin(), window.begin() + sampleCount);
+    std::sort(sortScratch.begin(), sortScratch.end());
+    double total = 0;
+    for (uint32_t sample : sortScratch) {
+        total += sample;
+    }
+    auto percentile = [this](double p) {
+        size_t index = static_cast<size_t>(p * (sortScratch.size() - 1) + 0.5);
+        return sortScratch[index] / 1000.0;
+    };
+    stats.average = total / sortScratch.size() / 1000.0;
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    stats.max = sortScratch.back() / 1000.0;
+    return stats;
+}
+
+ProfileStats Profiler::getPhaseStats(ProfilePhase phase) const {
+    return computeStats(samples[phase]);
+}
+
+ProfileStats Profiler::getFrameStats() const {
+    return computeStats(samples[PROFILE_PHASE_COUNT]);
+}
+
+int Profiler::getObstacleCount() const {
+    return obstacleCount;
+}
+
+const char* Profiler::getPhaseName(ProfilePhase phase) {
+    switch (phase) {
+        case PROFILE_EVENTS: return "Events";
+        case PROFILE_PLAYER: return "Player";
+        case PROFILE_WEATHER: return "Weather";
+        case PROFILE_SPAWN: return "Spawn";
+        case PROFILE_OBSTACLES: return "Obstacles";
+        case PROFILE_RENDER_WORLD: return "Render world";
+        case PROFILE_RENDER_TEXT: return "Render text";
+        case PROFILE_PRESENT: return "Present";
+        default: return "Unknown";
+    }
+}
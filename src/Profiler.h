@@ -0,0 +1,102 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum ProfilePhase {
+    PROFILE_EVENTS,
+    PROFILE_PLAYER,
+    PROFILE_WEATHER,
+    PROFILE_SPAWN,
+    PROFILE_OBSTACLES,
+    PROFILE_RENDER_WORLD,
+    PROFILE_RENDER_TEXT,
+    PROFILE_PRESENT,
+    PROFILE_PHASE_COUNT
+};
+
+struct ProfileStats {
+    double average, p50, p95, p99, max; // milliseconds
+};
+
+// Per-phase frame timings over a rolling window of frames, plus an optional
+// Chrome trace_event recording. When neither the stats nor a trace are active,
+// ProfileScope only does a null/flag check.
+class Profiler {
+public:
+    static const int WINDOW_FRAMES = 240;
+
+    Profiler();
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    bool isActive() const;
+    // Records every phase until stopTrace(), which writes the JSON file.
+    void startTrace(const std::string& path);
+    bool stopTrace();
+    // Trace events are written with this "tid" (default 1).
+    void setThreadId(int id);
+    // Appends another profiler's trace events, shifted onto this clock. The
+    // other profiler's thread must not be recording meanwhile.
+    void mergeTrace(const Profiler& other);
+
+    // Microseconds since the profiler was created.
+    uint64_t now() const;
+    void record(ProfilePhase phase, uint64_t start, uint64_t end);
+    // Adds time measured by another profiler to the current frame (no trace event).
+    void addTime(ProfilePhase phase, uint64_t micros);
+    // Time recorded for the phase since the last endFrame().
+    uint64_t getCurrentFrameTime(ProfilePhase phase) const;
+    // Closes the current frame: phase times accumulated since the last call
+    // become one sample each, and the frame time is measured between calls.
+    void endFrame(int obstacleCount);
+
+    ProfileStats getPhaseStats(ProfilePhase phase) const;
+    ProfileStats getFrameStats() const;
+    int getObstacleCount() const;
+    static const char* getPhaseName(ProfilePhase phase);
+
+private:
+    struct TraceEvent {
+        uint64_t start, duration;
+        ProfilePhase phase;
+        int threadId;
+    };
+
+    bool enabled;
+    bool tracing;
+    int threadId;
+    std::string tracePath;
+    std::vector<TraceEvent> traceEvents;
+    uint64_t origin;
+    uint64_t lastFrameEnd;
+    uint64_t currentFrame[PROFILE_PHASE_COUNT];
+    // Rolling windows in microseconds: one per phase, the last one for frames.
+    std::vector<uint32_t> samples[PROFILE_PHASE_COUNT + 1];
+    int sampleCursor;
+    int sampleCount;
+    int obstacleCount;
+    mutable std::vector<uint32_t> sortScratch;
+
+    ProfileStats computeStats(const std::vector<uint32_t>& window) const;
+};
+
+class ProfileScope {
+public:
+    ProfileScope(Profiler* profiler, ProfilePhase phase)
+        : profiler(profiler && profiler->isActive() ? profiler : nullptr), phase(phase),
+          start(this->profiler ? this->profiler->now() : 0) {}
+    ~ProfileScope() {
+        if (profiler) profiler->record(phase, start, profiler->now());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler* profiler;
+    ProfilePhase phase;
+    uint64_t start;
+};
+
+#endif
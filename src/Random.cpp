@@ -0,0 +1,37 @@
+#include "Random.h"
+
+namespace {
+const uint64_t PCG_MULTIPLIER = 6364136223846793005ull;
+}
+
+Random::Random(uint64_t seed, uint64_t stream) {
+    this->seed(seed, stream);
+}
+
+void Random::seed(uint64_t seed, uint64_t stream) {
+    state = 0;
+    increment = (stream << 1) | 1;
+    next();
+    state += seed;
+    next();
+}
+
+uint32_t Random::next() {
+    uint64_t old = state;
+    state = old * PCG_MULTIPLIER + increment;
+    uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+    uint32_t rotation = static_cast<uint32_t>(old >> 59);
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+int Random::nextInt(int bound) {
+    return static_cast<int>((static_cast<uint64_t>(next()) * static_cast<uint32_t>(bound)) >> 32);
+}
+
+uint64_t Random::getState() const {
+    return state;
+}
+
+void Random::setState(uint64_t newState) {
+    state = newState;
+}
@@ -0,0 +1,26 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Small PCG32 generator. Each subsystem owns one with its own stream, so the
+// spawner, weather and particles draw independent sequences from one seed and
+// adding draws in one of them does not shift the others.
+class Random {
+public:
+    explicit Random(uint64_t seed = 1, uint64_t stream = 0);
+    void seed(uint64_t seed, uint64_t stream);
+    uint32_t next();
+    // Uniform in [0, bound); bound must be positive.
+    int nextInt(int bound);
+
+    // The stream is fixed per subsystem, so the state alone restores a generator.
+    uint64_t getState() const;
+    void setState(uint64_t state);
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+#endif
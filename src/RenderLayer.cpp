@@ -0,0 +1,75 @@
+#include "RenderLayer.h"
+#include <iostream>
+
+RenderLayer::RenderLayer()
+    : renderer(nullptr), texture(nullptr), width(0), height(0), opaque(true), dirty(true), drawnKey(0) {}
+
+RenderLayer::~RenderLayer() {
+    release();
+}
+
+bool RenderLayer::init(SDL_Renderer* targetRenderer, int layerWidth, int layerHeight, bool isOpaque) {
+    release();
+    renderer = targetRenderer;
+    width = layerWidth;
+    height = layerHeight;
+    opaque = isOpaque;
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!texture) {
+        std::cerr << "Failed to create render layer: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    if (opaque) {
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    } else {
+        // Drawing blended text onto a clear target leaves premultiplied
+        // colors; plain alpha blending would darken the glyph edges again.
+        SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        if (SDL_SetTextureBlendMode(texture, premultiplied) != 0) {
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        }
+    }
+    dirty = true;
+    return true;
+}
+
+void RenderLayer::release() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+}
+
+bool RenderLayer::needsRedraw(int key) {
+    if (!dirty && key == drawnKey) {
+        return false;
+    }
+    dirty = false;
+    drawnKey = key;
+    return true;
+}
+
+void RenderLayer::invalidate() {
+    dirty = true;
+}
+
+void RenderLayer::begin() {
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+}
+
+void RenderLayer::end() {
+    SDL_SetRenderTarget(renderer, nullptr);
+}
+
+void RenderLayer::draw(int x, int y) {
+    SDL_Rect rect = {x, y, width, height};
+    SDL_RenderCopy(renderer, texture, nullptr, &rect);
+}
+
+int RenderLayer::getHeight() const {
+    return height;
+}
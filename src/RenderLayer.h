@@ -0,0 +1,42 @@
+#ifndef RENDER_LAYER_H
+#define RENDER_LAYER_H
+
+#include <SDL.h>
+
+// A render-target texture that is drawn into only when its content changes
+// and otherwise just copied to the screen. The caller describes the content
+// with a key (a score, a menu selection, ...); needsRedraw() reports when the
+// key changed or the layer was invalidated.
+class RenderLayer {
+public:
+    RenderLayer();
+    ~RenderLayer();
+    // Opaque layers replace what is under them; transparent ones start clear
+    // and are blended (premultiplied alpha where the renderer supports it).
+    bool init(SDL_Renderer* renderer, int width, int height, bool opaque);
+    // Frees the texture; must run before the renderer is destroyed.
+    void release();
+
+    // True when the content must be drawn again; remembers the key, so the
+    // caller is expected to redraw right away.
+    bool needsRedraw(int key);
+    // Forces the next needsRedraw() to return true (e.g. after the renderer
+    // lost its target textures).
+    void invalidate();
+
+    // Drawing goes into the layer (cleared first) until end().
+    void begin();
+    void end();
+    void draw(int x, int y);
+    int getHeight() const;
+
+private:
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    int width, height;
+    bool opaque;
+    bool dirty;
+    int drawnKey;
+};
+
+#endif
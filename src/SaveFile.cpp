@@ -0,0 +1,220 @@
+#include "SaveFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace {
+bool hostIsLittleEndian() {
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+uint32_t swapBytes(uint32_t value) {
+    return (value >> 24) | ((value >> 8) & 0xFF00u) | ((value << 8) & 0xFF0000u) | (value << 24);
+}
+
+uint64_t swapBytes(uint64_t value) {
+    return (static_cast<uint64_t>(swapBytes(static_cast<uint32_t>(value))) << 32) |
+           swapBytes(static_cast<uint32_t>(value >> 32));
+}
+
+template <typename T>
+T toLittleEndian(T value) {
+    return hostIsLittleEndian() ? value : swapBytes(value);
+}
+}
+
+SaveWriter::SaveWriter(size_t expectedSize) {
+    buffer.reserve(expectedSize);
+}
+
+void SaveWriter::writeBytes(const void* bytes, size_t count) {
+    const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+    buffer.insert(buffer.end(), begin, begin + count);
+}
+
+void SaveWriter::writeU32(uint32_t value) {
+    value = toLittleEndian(value);
+    writeBytes(&value, sizeof(value));
+}
+
+void SaveWriter::writeI32(int32_t value) {
+    writeU32(static_cast<uint32_t>(value));
+}
+
+void SaveWriter::writeU64(uint64_t value) {
+    value = toLittleEndian(value);
+    writeBytes(&value, sizeof(value));
+}
+
+void SaveWriter::writeF32(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU32(bits);
+}
+
+void SaveWriter::writeF64(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU64(bits);
+}
+
+void SaveWriter::writeFloats(const float* values, int count) {
+    if (count <= 0) {
+        return;
+    }
+    if (hostIsLittleEndian()) {
+        writeBytes(values, count * sizeof(float));
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        writeF32(values[i]);
+    }
+}
+
+void SaveWriter::patchU32(size_t offset, uint32_t value) {
+    value = toLittleEndian(value);
+    std::memcpy(buffer.data() + offset, &value, sizeof(value));
+}
+
+void SaveWriter::clear() {
+    buffer.clear();
+}
+
+void SaveWriter::reserve(size_t bytes) {
+    buffer.reserve(bytes);
+}
+
+size_t SaveWriter::size() const {
+    return buffer.size();
+}
+
+const std::vector<uint8_t>& SaveWriter::getBuffer() const {
+    return buffer;
+}
+
+SaveReader::SaveReader(const uint8_t* data, size_t size)
+    : data(data), size(size), position(0), failure(false) {}
+
+bool SaveReader::readBytes(void* bytes, size_t count) {
+    if (failure || count > size - position) {
+        failure = true;
+        std::memset(bytes, 0, count);
+        return false;
+    }
+    std::memcpy(bytes, data + position, count);
+    position += count;
+    return true;
+}
+
+uint32_t SaveReader::readU32() {
+    uint32_t value;
+    readBytes(&value, sizeof(value));
+    return toLittleEndian(value);
+}
+
+int32_t SaveReader::readI32() {
+    return static_cast<int32_t>(readU32());
+}
+
+uint64_t SaveReader::readU64() {
+    uint64_t value;
+    readBytes(&value, sizeof(value));
+    return toLittleEndian(value);
+}
+
+float SaveReader::readF32() {
+    uint32_t bits = readU32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double SaveReader::readF64() {
+    uint64_t bits = readU64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool SaveReader::readFloats(float* values, int count) {
+    if (count <= 0) {
+        return !failure;
+    }
+    if (!readBytes(values, count * sizeof(float))) {
+        return false;
+    }
+    if (!hostIsLittleEndian()) {
+        for (int i = 0; i < count; ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &values[i], sizeof(bits));
+            bits = swapBytes(bits);
+            std::memcpy(&values[i], &bits, sizeof(bits));
+        }
+    }
+    return true;
+}
+
+bool SaveReader::failed() const {
+    return failure;
+}
+
+size_t SaveReader::remaining() const {
+    return size - position;
+}
+
+uint32_t saveChecksum(const uint8_t* data, size_t size) {
+    // Four independent multiply-xor lanes over 8-byte words, so a multi-megabyte
+    // save is hashed at memory speed; the tail is folded in byte by byte.
+    const uint64_t prime = 0x9E3779B97F4A7C15ull;
+    uint64_t lanes[4] = {1, 2, 3, 4};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            word = toLittleEndian(word);
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+    uint64_t hash = size;
+    for (int lane = 0; lane < 4; ++lane) {
+        hash = (hash ^ lanes[lane]) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * prime;
+    }
+    hash ^= hash >> 32;
+    return static_cast<uint32_t>(hash);
+}
+
+bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool writeFileReplacing(const std::string& path, const std::vector<uint8_t>& data) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream outFile(tempPath, std::ios::binary | std::ios::trunc);
+        if (!outFile || !outFile.write(reinterpret_cast<const char*>(data.data()), data.size()) || !outFile.flush()) {
+            return false;
+        }
+    }
+    if (!replaceFile(tempPath, path)) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef SAVE_FILE_H
+#define SAVE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Little-endian encoding helpers for the binary savegame. Float arrays are
+// copied in bulk on little-endian hosts and byte-swapped otherwise.
+class SaveWriter {
+public:
+    explicit SaveWriter(size_t expectedSize = 0);
+    void writeU32(uint32_t value);
+    void writeI32(int32_t value);
+    void writeU64(uint64_t value);
+    void writeF32(float value);
+    void writeF64(double value);
+    void writeFloats(const float* values, int count);
+    void writeBytes(const void* bytes, size_t count);
+    // Overwrites a previously written 32-bit field, e.g. a size or checksum.
+    void patchU32(size_t offset, uint32_t value);
+    void clear();
+    void reserve(size_t bytes);
+
+    size_t size() const;
+    const std::vector<uint8_t>& getBuffer() const;
+
+private:
+    std::vector<uint8_t> buffer;
+};
+
+// Reads from a borrowed buffer (usually a MappedFile). Reading past the end
+// sets a sticky failure flag and yields zeros.
+class SaveReader {
+public:
+    SaveReader(const uint8_t* data, size_t size);
+    uint32_t readU32();
+    int32_t readI32();
+    uint64_t readU64();
+    float readF32();
+    double readF64();
+    bool readFloats(float* values, int count);
+    bool readBytes(void* bytes, size_t count);
+
+    bool failed() const;
+    size_t remaining() const;
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    bool failure;
+};
+
+// Fast non-cryptographic checksum used to detect truncated or corrupt saves.
+uint32_t saveChecksum(const uint8_t* data, size_t size);
+
+// Renames `from` over `to`, replacing it (MoveFileEx on Windows, where
+// rename() refuses to).
+bool replaceFile(const std::string& from, const std::string& to);
+// Writes `<path>.tmp` and renames it over `path`, so a crash mid-write leaves
+// the previous file intact. Prints nothing; the caller reports failures.
+bool writeFileReplacing(const std::string& path, const std::vector<uint8_t>& data);
+
+#endif
@@ -0,0 +1,170 @@
+#include "Scenario.h"
+#include "Percentile.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+struct Percentiles {
+    size_t count;
+    double p50, p95, p99, max;
+};
+
+Percentiles computePercentiles(std::vector<double> values) {
+    Percentiles result = {values.size(), 0, 0, 0, 0};
+    if (values.empty()) {
+        return result;
+    }
+    std::sort(values.begin(), values.end());
+    result.p50 = percentile(values, 50);
+    result.p95 = percentile(values, 95);
+    result.p99 = percentile(values, 99);
+    result.max = values.back();
+    return result;
+}
+
+void writePercentiles(std::ostream& out, const char* name, const Percentiles& stats, const char* unit) {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "  \"%s\": {\"count\": %zu, \"p50_%s\": %.3f, \"p95_%s\": %.3f, \"p99_%s\": %.3f, \"max_%s\": %.3f},\n",
+                  name, stats.count, unit, stats.p50, unit, stats.p95, unit, stats.p99, unit, stats.max);
+    out << line;
+}
+
+// Quoted and escaped; paths may hold backslashes and quotes.
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void printPercentiles(const char* name, const Percentiles& stats, const char* unit) {
+    std::printf("%-10s p50 %8.3f p95 %8.3f p99 %8.3f max %8.3f %s (%zu)\n", name, stats.p50, stats.p95, stats.p99,
+                stats.max, unit, stats.count);
+}
+}
+
+ScenarioReport::ScenarioReport()
+    : games(0), obstacleTotal(0), obstacleMax(0), rainDropTotal(0), rainDropMax(0) {}
+
+void ScenarioReport::reserve(size_t frames) {
+    frameMs.reserve(frames);
+    intervalMs.reserve(frames);
+}
+
+void ScenarioReport::gameStarted() {
+    ++games;
+}
+
+int ScenarioReport::getGameCount() const {
+    return games;
+}
+
+void ScenarioReport::addFrame(double workMs, double interval, int obstacles, int rainDrops) {
+    frameMs.push_back(workMs);
+    if (interval > 0) {
+        intervalMs.push_back(interval);
+    }
+    obstacleTotal += obstacles;
+    obstacleMax = std::max(obstacleMax, obstacles);
+    rainDropTotal += rainDrops;
+    rainDropMax = std::max(rainDropMax, rainDrops);
+}
+
+long ScenarioReport::getPeakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes there
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+bool ScenarioReport::write(const ScenarioConfig& config, const std::vector<float>& tickMicros) const {
+    Percentiles frames = computePercentiles(frameMs);
+    Percentiles intervals = computePercentiles(intervalMs);
+    Percentiles ticks = computePercentiles(std::vector<double>(tickMicros.begin(), tickMicros.end()));
+    size_t frameCount = frameMs.size();
+    double obstacleMean = frameCount ? static_cast<double>(obstacleTotal) / frameCount : 0;
+    double rainDropMean = frameCount ? static_cast<double>(rainDropTotal) / frameCount : 0;
+    long peakRss = getPeakRssKb();
+
+    printPercentiles("frame", frames, "ms");
+    printPercentiles("interval", intervals, "ms");
+    printPercentiles("tick", ticks, "us");
+    std::printf("games %d, obstacles mean %.1f max %d, rain drops mean %.1f max %d, peak RSS %ld KB\n", games,
+                obstacleMean, obstacleMax, rainDropMean, rainDropMax, peakRss);
+    std::fflush(stdout);
+
+    std::ofstream out(config.reportPath);
+    if (!out) {
+        std::cerr << "Failed to open " << config.reportPath << std::endl;
+        return false;
+    }
+    char line[256];
+    out << "{\n";
+    // Written straight to the stream: the path, seed and user-given numbers
+    // have no length limit.
+    out << std::fixed;
+    out << "  \"scenario\": {\"mode\": ";
+    writeJsonString(out, getModeInfo(config.mode).name);
+    out << ", \"seconds\": " << std::setprecision(1) << config.seconds;
+    out << ", \"spawn_interval_ms\": " << config.spawnInterval;
+    out << ", \"object_speed\": " << std::setprecision(2) << config.objectSpeed;
+    out << ", \"weather\": ";
+    writeJsonString(out, config.weatherForced ? getWeatherName(config.weather) : "cycle");
+    out << ", \"rain_drops_per_second\": " << std::setprecision(1) << config.rainDropsPerSecond;
+    out << ", \"rain_max_drops\": " << config.rainMaxDrops;
+    out << ", \"input\": ";
+    writeJsonString(out, config.input == ScenarioInput::BOT ? "bot" : "sweep");
+    out << ", \"renderer\": \"software\", \"video\": ";
+    writeJsonString(out, config.noWindow ? "dummy" : "window");
+    out << ", \"seed\": " << config.seed << ", \"report\": ";
+    writeJsonString(out, config.reportPath);
+    out << "},\n";
+    out << "  \"games\": " << games << ",\n";
+    writePercentiles(out, "frame", frames, "ms");
+    writePercentiles(out, "frame_interval", intervals, "ms");
+    writePercentiles(out, "tick", ticks, "us");
+    std::snprintf(line, sizeof(line), "  \"obstacles\": {\"mean\": %.1f, \"max\": %d},\n", obstacleMean, obstacleMax);
+    out << line;
+    std::snprintf(line, sizeof(line), "  \"rain_drops\": {\"mean\": %.1f, \"max\": %d},\n", rainDropMean, rainDropMax);
+    out << line;
+    out << "  \"peak_rss_kb\": " << peakRss << "\n";
+    out << "}\n";
+    if (!out) {
+        std::cerr << "Failed to write " << config.reportPath << std::endl;
+        return false;
+    }
+    std::cout << "Scenario report written to " << config.reportPath << std::endl;
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Constants.h"
+#include "GameModes.h"
+#include "WeatherSystem.h"
+
+enum class ScenarioInput { BOT, SWEEP };
+
+// A scripted load test of the whole game (Game --scenario): the mode plus
+// overrides that make it heavier, played by the AutoPilot or a fixed sweep of
+// the mouse target for a set wall-clock time. Games that end are restarted,
+// so the load lasts the whole run.
+struct ScenarioConfig {
+    GameMode mode = GameMode::CLASSIC;
+    double seconds = 30;
+    // 0 keeps the mode's own spawn schedule / speed curve.
+    int spawnInterval = 0;
+    float objectSpeed = 0;
+    bool weatherForced = false;
+    WeatherEffect weather = WeatherEffect::NONE;
+    float rainDropsPerSecond = RAIN_DROPS_PER_SECOND;
+    int rainMaxDrops = RAIN_MAX_DROPS;
+    ScenarioInput input = ScenarioInput::BOT;
+    // SDL's dummy video and audio drivers: no window, display or sound card.
+    bool noWindow = false;
+    uint64_t seed = 1;
+    std::string reportPath = "scenario_report.json";
+};
+
+// Per-frame samples of a scenario run and the JSON report written from them.
+class ScenarioReport {
+public:
+    ScenarioReport();
+    // Room for this many frames, so sampling does not allocate mid-run.
+    void reserve(size_t frames);
+    void gameStarted();
+    int getGameCount() const;
+    // Frame work time (start of the frame to the return of present, without
+    // pacing), time since the previous frame (0 for the first, which is
+    // skipped) and what was on screen.
+    void addFrame(double workMs, double intervalMs, int obstacles, int rainDrops);
+
+    // Frame, interval and tick (microseconds, from SimThread) percentiles,
+    // obstacle and drop counts and the process's peak RSS.
+    bool write(const ScenarioConfig& config, const std::vector<float>& tickMicros) const;
+    // Peak resident set size in KB, or -1 where it cannot be read.
+    static long getPeakRssKb();
+
+private:
+    int games;
+    std::vector<double> frameMs;
+    std::vector<double> intervalMs;
+    long long obstacleTotal;
+    int obstacleMax;
+    long long rainDropTotal;
+    int rainDropMax;
+};
+
+#endif
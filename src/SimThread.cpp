@@ -0,0 +1,168 @@
+#include "SimThread.h"
+#include "AllocationCounter.h"
+#include "Constants.h"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+const Clock::duration TICK_PERIOD =
+    std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(SIM_TICK_MS));
+// Further behind than this (a debugger break, a suspended laptop) the thread
+// skips ahead instead of running every missed tick back to back.
+const Clock::duration MAX_LAG =
+    std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(MAX_FRAME_MS));
+const size_t SNAPSHOT_RESERVED_OBSTACLES = 4096;
+}
+
+WorldSnapshot::WorldSnapshot()
+    : tick(0), inputSeq(0), mode(GameMode::CLASSIC), status(SimStatus::RUNNING), playerX(0), playerY(0),
+      previousPlayerX(0), previousPlayerY(0), obstacleCount(0), score(0), elapsedTime(0), timeSinceFlash(0),
+      phaseTime(), allocations(0) {
+    // Far more than a normal game has on screen, so the copies do not grow
+    // (and allocate) partway through one.
+    obstacleX.reserve(SNAPSHOT_RESERVED_OBSTACLES);
+    obstacleY.reserve(SNAPSHOT_RESERVED_OBSTACLES);
+    obstacleDX.reserve(SNAPSHOT_RESERVED_OBSTACLES);
+    obstacleDY.reserve(SNAPSHOT_RESERVED_OBSTACLES);
+}
+
+void WorldSnapshot::capture(const Simulation& simulation, const Profiler& profiler) {
+    mode = simulation.getMode();
+    status = simulation.getStatus();
+    playerX = simulation.getPlayerX();
+    playerY = simulation.getPlayerY();
+    const ObstaclePool& obstacles = simulation.getObstacles();
+    obstacleCount = obstacles.size();
+    obstacleX.assign(obstacles.getX(), obstacles.getX() + obstacleCount);
+    obstacleY.assign(obstacles.getY(), obstacles.getY() + obstacleCount);
+    obstacleDX.assign(obstacles.getDX(), obstacles.getDX() + obstacleCount);
+    obstacleDY.assign(obstacles.getDY(), obstacles.getDY() + obstacleCount);
+    weather = simulation.getWeatherSystem();
+    score = simulation.getScore();
+    elapsedTime = simulation.getElapsedTime();
+    timeSinceFlash = simulation.getTimeSinceFlash();
+    for (int p = 0; p < PROFILE_PHASE_COUNT; ++p) {
+        phaseTime[p] = profiler.getCurrentFrameTime(static_cast<ProfilePhase>(p));
+    }
+}
+
+SimThread::SimThread(Simulation& simulation)
+    : simulation(simulation), inputLog(nullptr), pilot(nullptr), stopRequested(false), targetX(0), targetY(0), lastSeq(0) {
+    // Cheap at the tick rate, and it keeps the phase totals the render thread
+    // folds into its own frames.
+    profiler.setEnabled(true);
+    profiler.setThreadId(2);
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::start(InputLog* log, AutoPilot* autoPilot) {
+    stop();
+    inputLog = log;
+    pilot = autoPilot;
+    SimCommand stale;
+    while (inputQueue.pop(stale)) {}
+    targetX = simulation.getPlayerX();
+    targetY = simulation.getPlayerY();
+    lastSeq = 0;
+
+    WorldSnapshot& snapshot = snapshots.getWriteBuffer();
+    snapshot.capture(simulation, profiler);
+    snapshot.previousPlayerX = snapshot.playerX;
+    snapshot.previousPlayerY = snapshot.playerY;
+    snapshot.tick = 0;
+    snapshot.tickTime = Clock::now();
+    snapshot.inputSeq = lastSeq;
+    snapshot.allocations = 0;
+    snapshots.publish();
+
+    stopRequested.store(false);
+    thread = std::thread(&SimThread::threadMain, this);
+}
+
+void SimThread::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+    stopRequested.store(true);
+    thread.join();
+    inputLog = nullptr;
+}
+
+bool SimThread::isRunning() const {
+    return thread.joinable();
+}
+
+bool SimThread::pushInput(const SimCommand& command) {
+    return inputQueue.push(command);
+}
+
+const WorldSnapshot& SimThread::acquireSnapshot() {
+    snapshots.update();
+    return snapshots.getReadBuffer();
+}
+
+Profiler& SimThread::getProfiler() {
+    return profiler;
+}
+
+void SimThread::recordTickTimes(size_t maxTicks) {
+    tickTimes.clear();
+    tickTimes.shrink_to_fit();
+    tickTimes.reserve(maxTicks);
+}
+
+const std::vector<float>& SimThread::getTickTimes() const {
+    return tickTimes;
+}
+
+void SimThread::threadMain() {
+    uint64_t tick = 0;
+    Clock::time_point nextTick = Clock::now() + TICK_PERIOD;
+    while (!stopRequested.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_until(nextTick);
+        Clock::time_point tickStart = Clock::now();
+
+        // Several Flash presses between two ticks count as one, as before.
+        bool flash = false;
+        SimCommand command;
+        while (inputQueue.pop(command)) {
+            lastSeq = command.seq;
+            if (command.type == SimCommand::TARGET) {
+                targetX = command.x;
+                targetY = command.y;
+            } else {
+                flash = true;
+            }
+        }
+        SimInput input = pilot ? pilot->decide(simulation) : SimInput{targetX, targetY, flash};
+        float previousX = simulation.getPlayerX();
+        float previousY = simulation.getPlayerY();
+        if (inputLog) inputLog->record(input);
+        simulation.step(input, SIM_TICK_MS);
+
+        WorldSnapshot& snapshot = snapshots.getWriteBuffer();
+        snapshot.capture(simulation, profiler);
+        snapshot.previousPlayerX = previousX;
+        snapshot.previousPlayerY = previousY;
+        snapshot.tick = ++tick;
+        snapshot.tickTime = nextTick;
+        snapshot.inputSeq = lastSeq;
+        snapshot.allocations = AllocationCounter::getThreadCount();
+        snapshots.publish();
+        if (tickTimes.size() < tickTimes.capacity()) {
+            tickTimes.push_back(std::chrono::duration<float, std::micro>(Clock::now() - tickStart).count());
+        }
+
+        if (simulation.getStatus() != SimStatus::RUNNING) {
+            break;
+        }
+        nextTick += TICK_PERIOD;
+        Clock::time_point now = Clock::now();
+        if (now - nextTick > MAX_LAG) {
+            nextTick = now;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "AutoPilot.h"
+#include "InputLog.h"
+#include "Profiler.h"
+#include "Simulation.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+struct SimCommand {
+    enum Type { TARGET, FLASH };
+    Type type;
+    float x, y;
+    // Chosen by the sender and echoed in WorldSnapshot::inputSeq once consumed.
+    uint32_t seq;
+};
+
+// Everything the renderer needs from one simulation tick, copied out so the
+// simulation can move on while the frame is drawn.
+struct WorldSnapshot {
+    // Ticks since start(); 0 is the state start() found.
+    uint64_t tick;
+    // When the tick was due; drawing interpolates from here.
+    std::chrono::steady_clock::time_point tickTime;
+    // Sequence number of the last command this tick (or an earlier one) consumed.
+    uint32_t inputSeq;
+    GameMode mode;
+    SimStatus status;
+    float playerX, playerY;
+    float previousPlayerX, previousPlayerY;
+    int obstacleCount;
+    std::vector<float> obstacleX, obstacleY, obstacleDX, obstacleDY;
+    WeatherSystem weather;
+    int score;
+    double elapsedTime;
+    double timeSinceFlash;
+    // Running totals of the simulation's profiler phases (microseconds).
+    uint64_t phaseTime[PROFILE_PHASE_COUNT];
+    // Heap allocations made by the simulation thread so far (0 before it runs).
+    uint64_t allocations;
+
+    WorldSnapshot();
+    // Copies only the live obstacles; the vectors keep their capacity.
+    void capture(const Simulation& simulation, const Profiler& profiler);
+};
+
+// Runs Simulation::step at SIM_TICK_RATE on its own thread. Input arrives
+// through a lock-free queue and each tick is published as a WorldSnapshot
+// through a triple buffer, so neither side ever blocks the other. The thread
+// stops by itself once the game ends.
+class SimThread {
+public:
+    explicit SimThread(Simulation& simulation);
+    ~SimThread();
+    // Ticks the simulation from its current state. Until stop() the caller
+    // must not touch the simulation, or the log if one is given; each tick's
+    // input is recorded into it. With a pilot, it decides every tick's input
+    // and pushed input is ignored.
+    void start(InputLog* log, AutoPilot* pilot = nullptr);
+    // Lets the current tick finish and joins the thread. Queued input that was
+    // not consumed yet is dropped.
+    void stop();
+    bool isRunning() const;
+
+    // Producer side (event thread). Returns false if the queue is full.
+    bool pushInput(const SimCommand& command);
+    // Reader side (render thread): the newest snapshot, valid until the next call.
+    const WorldSnapshot& acquireSnapshot();
+    // Collects the simulation phases; only touched by the thread that owns the
+    // simulation (the game thread while stopped).
+    Profiler& getProfiler();
+    // Keeps the work time of up to maxTicks ticks (input, step, snapshot),
+    // across starts, for load tests; 0 turns it off. Call while stopped.
+    void recordTickTimes(size_t maxTicks);
+    // Microseconds per tick; read while stopped.
+    const std::vector<float>& getTickTimes() const;
+
+private:
+    static const size_t INPUT_QUEUE_SIZE = 1024;
+
+    Simulation& simulation;
+    InputLog* inputLog;
+    AutoPilot* pilot;
+    Profiler profiler;
+    std::thread thread;
+    std::atomic<bool> stopRequested;
+    SpscQueue<SimCommand, INPUT_QUEUE_SIZE> inputQueue;
+    TripleBuffer<WorldSnapshot> snapshots;
+    float targetX, targetY;
+    uint32_t lastSeq;
+    // Reserved by recordTickTimes() and never grown by the thread.
+    std::vector<float> tickTimes;
+
+    void threadMain();
+};
+
+#endif
@@ -0,0 +1,388 @@
+#include "Simulation.h"
+#include "Collision.h"
+#include "Constants.h"
+#include "MappedFile.h"
+#include "SaveFile.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace {
+const uint32_t SAVE_MAGIC = 0x56415344; // "DSAV" in file byte order
+// Version 2 added the random generator states.
+const uint32_t SAVE_VERSION = 2;
+const size_t SAVE_HEADER_SIZE = 16;
+const uint64_t SPAWN_STREAM = 1;
+}
+
+// Indexed by GameMode.
+const Simulation::StepFunction Simulation::STEP_FUNCTIONS[GAME_MODE_COUNT] = {
+    &Simulation::stepMode<ClassicMode>,
+    &Simulation::stepMode<SurvivalRushMode>,
+};
+
+Simulation::Simulation()
+    : profiler(nullptr), jobs(nullptr), obstacles(MAX_OBSTACLES), spawnIntervalOverride(0), objectSpeedOverride(0),
+      spawnRandom(1, SPAWN_STREAM) {
+    reset(GameMode::CLASSIC);
+}
+
+void Simulation::seed(uint64_t seed) {
+    spawnRandom.seed(seed, SPAWN_STREAM);
+    weatherSystem.seedRandom(seed);
+}
+
+void Simulation::reset(GameMode newMode) {
+    mode = newMode;
+    stepFunction = STEP_FUNCTIONS[static_cast<int>(mode)];
+    status = SimStatus::RUNNING;
+    playerX = WINDOW_WIDTH / 2.0f - PLAYER_WIDTH / 2.0f;
+    playerY = WINDOW_HEIGHT / 2.0f - PLAYER_HEIGHT / 2.0f;
+    obstacles.clear();
+    weatherSystem.reset();
+    elapsedTime = 0;
+    lastSpawnTime = 0;
+    lastFlashTime = -FLASH_COOLDOWN - 1;
+    score = 0;
+    currentObjectSpeed = INITIAL_OBJECT_SPEED;
+    currentSpawnInterval = getModeInfo(mode).initialSpawnInterval;
+}
+
+void Simulation::setRainIntensity(float dropsPerSecond, int maxDrops) {
+    weatherSystem.setRainIntensity(dropsPerSecond, maxDrops);
+}
+
+void Simulation::setForcedWeather(WeatherEffect effect) {
+    weatherSystem.setForcedWeather(effect);
+}
+
+void Simulation::clearForcedWeather() {
+    weatherSystem.clearForcedWeather();
+}
+
+void Simulation::setDifficultyOverride(int spawnInterval, float objectSpeed) {
+    spawnIntervalOverride = spawnInterval;
+    objectSpeedOverride = objectSpeed;
+}
+
+void Simulation::setProfiler(Profiler* newProfiler) {
+    profiler = newProfiler;
+}
+
+void Simulation::setJobSystem(JobSystem* newJobs) {
+    jobs = newJobs;
+    weatherSystem.setJobSystem(newJobs);
+}
+
+bool Simulation::checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2) {
+    return x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2;
+}
+
+float Simulation::distance(float x1, float y1, float x2, float y2) {
+    return std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+}
+
+namespace {
+void clampToWindow(float& x, float& y) {
+    if (x < 0) x = 0;
+    if (x > WINDOW_WIDTH - PLAYER_WIDTH) x = WINDOW_WIDTH - PLAYER_WIDTH;
+    if (y < 0) y = 0;
+    if (y > WINDOW_HEIGHT - PLAYER_HEIGHT) y = WINDOW_HEIGHT - PLAYER_HEIGHT;
+}
+}
+
+void Simulation::flash(float targetX, float targetY) {
+    if (elapsedTime - lastFlashTime < FLASH_COOLDOWN) {
+        return;
+    }
+    float dx = targetX - playerX;
+    float dy = targetY - playerY;
+    float dist = distance(playerX, playerY, targetX, targetY);
+    if (dist > 0) {
+        float fromX = playerX;
+        float fromY = playerY;
+        playerX += (dx / dist) * FLASH_DISTANCE;
+        playerY += (dy / dist) * FLASH_DISTANCE;
+        clampToWindow(playerX, playerY);
+        lastFlashTime = elapsedTime;
+
+        // The jump is instant, so the obstacles stand still along its path.
+        SweptRect path = {fromX, fromY, playerX, playerY, PLAYER_WIDTH, PLAYER_HEIGHT};
+        for (int i = 0; i < obstacles.size(); ++i) {
+            float x = obstacles.getX()[i];
+            float y = obstacles.getY()[i];
+            SweptRect obstacle = {x, y, x, y, OBJECT_SIZE, OBJECT_SIZE};
+            if (sweptCollisionTime(path, obstacle) >= 0.0f) {
+                status = SimStatus::COLLIDED;
+                return;
+            }
+        }
+    }
+}
+
+void Simulation::walkToward(float& x, float& y, float targetX, float targetY, float speed, float frames) {
+    float dist = distance(x, y, targetX, targetY);
+    if (dist > 5.0f) {
+        float dx = targetX - x;
+        float dy = targetY - y;
+        float moveX = (dx / dist) * speed * frames;
+        float moveY = (dy / dist) * speed * frames;
+
+        if (std::fabs(moveX) > std::fabs(dx)) moveX = dx;
+        if (std::fabs(moveY) > std::fabs(dy)) moveY = dy;
+
+        x += moveX;
+        y += moveY;
+        clampToWindow(x, y);
+    }
+}
+
+void Simulation::movePlayerToTarget(float targetX, float targetY, float frames) {
+    float effectiveSpeed = (weatherSystem.getCurrentWeather() == WeatherEffect::RAIN) ? RAIN_PLAYER_SPEED : PLAYER_SPEED;
+    walkToward(playerX, playerY, targetX, targetY, effectiveSpeed, frames);
+}
+
+void Simulation::step(const SimInput& input, float dt) {
+    if (status != SimStatus::RUNNING) {
+        return;
+    }
+    (this->*stepFunction)(input, dt);
+}
+
+template <typename Mode>
+void Simulation::stepMode(const SimInput& input, float dt) {
+    float frames = dt / SIM_FRAME_MS;
+    double stepStart = elapsedTime;
+    elapsedTime += dt;
+
+    // Where the player walks from this step; the obstacle sweep starts here.
+    float startX, startY;
+    {
+        ProfileScope scope(profiler, PROFILE_PLAYER);
+        if (input.flash) {
+            flash(input.targetX, input.targetY);
+            if (status == SimStatus::COLLIDED) {
+                score = Mode::score(elapsedTime);
+                return;
+            }
+        }
+        startX = playerX;
+        startY = playerY;
+        movePlayerToTarget(input.targetX, input.targetY, frames);
+    }
+    {
+        ProfileScope scope(profiler, PROFILE_WEATHER);
+        weatherSystem.updateWeather(static_cast<uint32_t>(elapsedTime), Mode::WEATHER_INTERVAL, Mode::WEATHER_DURATION, dt);
+    }
+
+    if constexpr (Mode::TIME_LIMIT > 0) {
+        if (elapsedTime >= Mode::TIME_LIMIT) {
+            score = Mode::score(elapsedTime);
+            status = SimStatus::TIME_UP;
+            return;
+        }
+    }
+    currentSpawnInterval = spawnIntervalOverride > 0 ? spawnIntervalOverride : Mode::spawnInterval(elapsedTime, currentSpawnInterval);
+
+    {
+        ProfileScope scope(profiler, PROFILE_SPAWN);
+        // Every spawn that fell due during the step, each backed off by the
+        // part of the step before it was due, so long steps spawn on the
+        // same schedule as short ones.
+        while (elapsedTime - lastSpawnTime > currentSpawnInterval) {
+            lastSpawnTime += currentSpawnInterval;
+            currentObjectSpeed = objectSpeedOverride > 0 ? objectSpeedOverride : Mode::objectSpeed(elapsedTime, currentObjectSpeed);
+            GameObject obj = spawnObject(currentObjectSpeed, spawnRandom);
+            float early = static_cast<float>(std::max(lastSpawnTime - stepStart, 0.0) / SIM_FRAME_MS);
+            obj.x -= obj.dx * early;
+            obj.y -= obj.dy * early;
+            obstacles.add(obj);
+        }
+    }
+
+    {
+        ProfileScope scope(profiler, PROFILE_OBSTACLES);
+        SweptRect player = {startX, startY, playerX, playerY, PLAYER_WIDTH, PLAYER_HEIGHT};
+        bool hit = jobs ? obstacles.integrate(*jobs, frames, player) : obstacles.integrate(frames, player);
+        if (hit) {
+            status = SimStatus::COLLIDED;
+        }
+    }
+
+    score = Mode::score(elapsedTime);
+}
+
+void Simulation::writeState(SaveWriter& writer) const {
+    writer.writeI32(static_cast<int32_t>(mode));
+    writer.writeI32(static_cast<int32_t>(status));
+    writer.writeF32(playerX);
+    writer.writeF32(playerY);
+    writer.writeF64(elapsedTime);
+    writer.writeF64(lastSpawnTime);
+    writer.writeF64(lastFlashTime);
+    writer.writeI32(score);
+    writer.writeF32(currentObjectSpeed);
+    writer.writeI32(currentSpawnInterval);
+    weatherSystem.save(writer);
+    obstacles.save(writer);
+    writer.writeU64(spawnRandom.getState());
+    weatherSystem.saveRandomState(writer);
+}
+
+bool Simulation::saveState(const std::string& path) const {
+    SaveWriter writer(SAVE_HEADER_SIZE + 128 + (obstacles.size() + weatherSystem.getRainDropCount()) * 16);
+    writer.writeU32(SAVE_MAGIC);
+    writer.writeU32(SAVE_VERSION);
+    writer.writeU32(0); // payload size, patched below
+    writer.writeU32(0); // payload checksum, patched below
+    size_t payloadStart = writer.size();
+    writeState(writer);
+
+    const std::vector<uint8_t>& buffer = writer.getBuffer();
+    writer.patchU32(8, static_cast<uint32_t>(buffer.size() - payloadStart));
+    writer.patchU32(12, saveChecksum(buffer.data() + payloadStart, buffer.size() - payloadStart));
+
+    // Through a temporary file, so a crash mid-write keeps the previous save.
+    if (!writeFileReplacing(path, buffer)) {
+        std::cerr << "Failed to save game state!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint64_t Simulation::getStateHash() const {
+    SaveWriter writer(128 + (obstacles.size() + weatherSystem.getRainDropCount()) * 16);
+    writeState(writer);
+    // FNV-1a over the serialized state.
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : writer.getBuffer()) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool Simulation::loadState(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Save game file not found!" << std::endl;
+        return false;
+    }
+    SaveReader header(file.data(), file.size());
+    if (header.readU32() != SAVE_MAGIC) {
+        file.close();
+        return loadLegacyState(path);
+    }
+    uint32_t version = header.readU32();
+    uint32_t payloadSize = header.readU32();
+    uint32_t checksum = header.readU32();
+    if (header.failed() || version == 0 || version > SAVE_VERSION) {
+        std::cerr << "Unsupported save game version " << version << std::endl;
+        return false;
+    }
+    const uint8_t* payload = file.data() + SAVE_HEADER_SIZE;
+    if (payloadSize != header.remaining() || saveChecksum(payload, payloadSize) != checksum) {
+        std::cerr << "Save game file is corrupt!" << std::endl;
+        return false;
+    }
+
+    SaveReader reader(payload, payloadSize);
+    int32_t savedMode = reader.readI32();
+    int32_t savedStatus = reader.readI32();
+    bool valid = savedMode >= 0 && savedMode < GAME_MODE_COUNT &&
+                 savedStatus >= 0 && savedStatus <= static_cast<int32_t>(SimStatus::TIME_UP);
+    reset(valid ? static_cast<GameMode>(savedMode) : GameMode::CLASSIC);
+    if (valid) {
+        status = static_cast<SimStatus>(savedStatus);
+        playerX = reader.readF32();
+        playerY = reader.readF32();
+        elapsedTime = reader.readF64();
+        lastSpawnTime = reader.readF64();
+        lastFlashTime = reader.readF64();
+        score = reader.readI32();
+        currentObjectSpeed = reader.readF32();
+        currentSpawnInterval = reader.readI32();
+        // The spawn loop in step() needs a positive interval and finite
+        // times, and would spawn once per interval of a stale lastSpawnTime.
+        valid = currentSpawnInterval > 0 && std::isfinite(elapsedTime) && std::isfinite(lastSpawnTime) &&
+                weatherSystem.load(reader) && obstacles.load(reader);
+        lastSpawnTime = std::max(lastSpawnTime, elapsedTime - currentSpawnInterval);
+        // Version 1 saves keep the generators as currently seeded.
+        if (valid && version >= 2) {
+            spawnRandom.setState(reader.readU64());
+            weatherSystem.loadRandomState(reader);
+        }
+        valid = valid && !reader.failed() && reader.remaining() == 0;
+    }
+    if (!valid) {
+        std::cerr << "Save game file is corrupt!" << std::endl;
+        reset(GameMode::CLASSIC);
+        return false;
+    }
+    return true;
+}
+
+// Pre-binary savegame.txt: player position, elapsed ms, score and one
+// "x y dx dy" line per obstacle. Everything else restarts from its default.
+bool Simulation::loadLegacyState(const std::string& path) {
+    std::ifstream inFile(path);
+    if (!inFile) {
+        std::cerr << "Save game file not found!" << std::endl;
+        return false;
+    }
+    reset(GameMode::CLASSIC);
+    inFile >> playerX >> playerY;
+    inFile >> elapsedTime;
+    inFile >> score;
+    size_t numObjects = 0;
+    inFile >> numObjects;
+    for (size_t i = 0; i < numObjects && inFile; ++i) {
+        GameObject obj;
+        inFile >> obj.x >> obj.y >> obj.dx >> obj.dy;
+        obstacles.add(obj);
+    }
+    if (!inFile) {
+        std::cerr << "Save game file is corrupt!" << std::endl;
+        reset(GameMode::CLASSIC);
+        return false;
+    }
+    lastSpawnTime = elapsedTime;
+    lastFlashTime = elapsedTime - FLASH_COOLDOWN - 1;
+    return true;
+}
+
+GameMode Simulation::getMode() const {
+    return mode;
+}
+
+SimStatus Simulation::getStatus() const {
+    return status;
+}
+
+float Simulation::getPlayerX() const {
+    return playerX;
+}
+
+float Simulation::getPlayerY() const {
+    return playerY;
+}
+
+const ObstaclePool& Simulation::getObstacles() const {
+    return obstacles;
+}
+
+const WeatherSystem& Simulation::getWeatherSystem() const {
+    return weatherSystem;
+}
+
+int Simulation::getScore() const {
+    return score;
+}
+
+double Simulation::getElapsedTime() const {
+    return elapsedTime;
+}
+
+double Simulation::getTimeSinceFlash() const {
+    return elapsedTime - lastFlashTime;
+}
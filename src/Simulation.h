@@ -0,0 +1,101 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <string>
+#include "GameModes.h"
+#include "GameObject.h"
+#include "JobSystem.h"
+#include "ObstaclePool.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "WeatherSystem.h"
+
+enum class SimStatus { RUNNING, COLLIDED, TIME_UP };
+
+struct SimInput {
+    float targetX, targetY;
+    bool flash;
+};
+
+// Gameplay state and rules (spawning, movement, collision, scoring, weather).
+// Has no SDL video/mixer/ttf dependency so it can run headless at any speed;
+// Game is only a front-end that feeds it input and draws its state.
+class Simulation {
+public:
+    Simulation();
+    // Seeds the spawner, weather and rain generators. Not touched by reset(),
+    // so consecutive games continue the same sequences.
+    void seed(uint64_t seed);
+    void reset(GameMode mode);
+    // Advances the game by dt milliseconds, through the step instantiated for
+    // the current mode (picked once in reset()).
+    void step(const SimInput& input, float dt);
+    // Binary snapshot of the whole game (little-endian, versioned, checksummed).
+    // loadState maps the file and also accepts the legacy text savegame.
+    bool saveState(const std::string& path) const;
+    bool loadState(const std::string& path);
+    // Hash of everything saveState writes; equal hashes mean equal games.
+    uint64_t getStateHash() const;
+    void setRainIntensity(float dropsPerSecond, int maxDrops);
+    // Pins the weather (see WeatherSystem::setForcedWeather).
+    void setForcedWeather(WeatherEffect effect);
+    void clearForcedWeather();
+    // Stress scenarios: spawn every `spawnInterval` ms at `objectSpeed` px per
+    // frame instead of following the mode's schedule; 0 keeps the mode's.
+    // Like the rain settings this is configuration: it survives reset(), is
+    // not saved and is not part of the state hash.
+    void setDifficultyOverride(int spawnInterval, float objectSpeed);
+    // Optional; step() then reports its phases to it. Not owned.
+    void setProfiler(Profiler* profiler);
+    // Optional; obstacles and rain are then updated in parallel chunks when
+    // there are enough of them. Results do not depend on it. Not owned.
+    void setJobSystem(JobSystem* jobs);
+
+    static bool checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2);
+    static float distance(float x1, float y1, float x2, float y2);
+    // The player's walk: `speed` pixels per frame straight towards the target,
+    // stopping within 5 px of it and kept inside the window. Also used to
+    // predict the player outside the simulation (AutoPilot, late latching).
+    static void walkToward(float& x, float& y, float targetX, float targetY, float speed, float frames);
+
+    GameMode getMode() const;
+    SimStatus getStatus() const;
+    float getPlayerX() const;
+    float getPlayerY() const;
+    const ObstaclePool& getObstacles() const;
+    const WeatherSystem& getWeatherSystem() const;
+    int getScore() const;
+    double getElapsedTime() const;
+    double getTimeSinceFlash() const;
+
+private:
+    typedef void (Simulation::*StepFunction)(const SimInput&, float);
+
+    GameMode mode;
+    StepFunction stepFunction;
+    static const StepFunction STEP_FUNCTIONS[GAME_MODE_COUNT];
+    SimStatus status;
+    Profiler* profiler;
+    JobSystem* jobs;
+    float playerX, playerY;
+    ObstaclePool obstacles;
+    WeatherSystem weatherSystem;
+    double elapsedTime;
+    double lastSpawnTime;
+    double lastFlashTime;
+    int score;
+    float currentObjectSpeed;
+    int currentSpawnInterval;
+    int spawnIntervalOverride;
+    float objectSpeedOverride;
+    Random spawnRandom;
+
+    void writeState(SaveWriter& writer) const;
+    bool loadLegacyState(const std::string& path);
+    void flash(float targetX, float targetY);
+    void movePlayerToTarget(float targetX, float targetY, float frames);
+    template <typename Mode>
+    void stepMode(const SimInput& input, float dt);
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "SpatialGrid.h"
+#include "Constants.h"
+#include <algorithm>
+
+namespace {
+const float GRID_ORIGIN = -OBJECT_SIZE;
+const float GRID_INV_CELL_SIZE = 1.0f / OBJECT_SIZE;
+}
+
+SpatialGrid::SpatialGrid()
+    : cols((WINDOW_WIDTH + 2 * OBJECT_SIZE) / OBJECT_SIZE + 1),
+      rows((WINDOW_HEIGHT + 2 * OBJECT_SIZE) / OBJECT_SIZE + 1),
+      stamp(1),
+      cellStamp(cols * rows, 0),
+      cellHead(cols * rows, -1) {}
+
+int SpatialGrid::cellX(float x) const {
+    // Truncation differs from floor only below the origin, where both clamp to 0.
+    int cx = static_cast<int>((x - GRID_ORIGIN) * GRID_INV_CELL_SIZE);
+    return std::min(std::max(cx, 0), cols - 1);
+}
+
+int SpatialGrid::cellY(float y) const {
+    int cy = static_cast<int>((y - GRID_ORIGIN) * GRID_INV_CELL_SIZE);
+    return std::min(std::max(cy, 0), rows - 1);
+}
+
+int SpatialGrid::head(int cell) const {
+    return cellStamp[cell] == stamp ? cellHead[cell] : -1;
+}
+
+void SpatialGrid::clear() {
+    if (++stamp == 0) {
+        std::fill(cellStamp.begin(), cellStamp.end(), 0);
+        stamp = 1;
+    }
+    entries.clear();
+}
+
+void SpatialGrid::rebuild(const ObstaclePool& obstacles) {
+    clear();
+    int count = obstacles.size();
+    const float* xs = obstacles.getX();
+    const float* ys = obstacles.getY();
+    entries.resize(count);
+    for (int i = 0; i < count; ++i) {
+        int cell = cellY(ys[i]) * cols + cellX(xs[i]);
+        Entry& entry = entries[i];
+        entry.x = xs[i];
+        entry.y = ys[i];
+        entry.next = head(cell);
+        cellStamp[cell] = stamp;
+        cellHead[cell] = i;
+    }
+}
+
+bool SpatialGrid::overlapsRect(float x, float y, float w, float h) const {
+    int x0 = cellX(x - OBJECT_SIZE), x1 = cellX(x + w);
+    int y0 = cellY(y - OBJECT_SIZE), y1 = cellY(y + h);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            for (int e = head(cy * cols + cx); e != -1; e = entries[e].next) {
+                const Entry& entry = entries[e];
+                if (x < entry.x + OBJECT_SIZE && x + w > entry.x &&
+                    y < entry.y + OBJECT_SIZE && y + h > entry.y) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void SpatialGrid::queryRect(float x, float y, float w, float h, std::vector<int>& result) const {
+    int x0 = cellX(x - OBJECT_SIZE), x1 = cellX(x + w);
+    int y0 = cellY(y - OBJECT_SIZE), y1 = cellY(y + h);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            for (int e = head(cy * cols + cx); e != -1; e = entries[e].next) {
+                const Entry& entry = entries[e];
+                if (x < entry.x + OBJECT_SIZE && x + w > entry.x &&
+                    y < entry.y + OBJECT_SIZE && y + h > entry.y) {
+                    result.push_back(e);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryRadius(float cx, float cy, float radius, std::vector<int>& result) const {
+    int x0 = cellX(cx - radius - OBJECT_SIZE), x1 = cellX(cx + radius);
+    int y0 = cellY(cy - radius - OBJECT_SIZE), y1 = cellY(cy + radius);
+    float radiusSq = radius * radius;
+    for (int gy = y0; gy <= y1; ++gy) {
+        for (int gx = x0; gx <= x1; ++gx) {
+            for (int e = head(gy * cols + gx); e != -1; e = entries[e].next) {
+                const Entry& entry = entries[e];
+                float nearestX = std::min(std::max(cx, entry.x), entry.x + OBJECT_SIZE);
+                float nearestY = std::min(std::max(cy, entry.y), entry.y + OBJECT_SIZE);
+                float dx = cx - nearestX;
+                float dy = cy - nearestY;
+                if (dx * dx + dy * dy <= radiusSq) {
+                    result.push_back(e);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+#include "ObstaclePool.h"
+
+// Uniform grid over the playfield (plus the one-obstacle spawn margin around it)
+// with OBJECT_SIZE cells. Each obstacle is binned by its top-left corner, so a
+// query only has to widen its cell range by one obstacle on the low side.
+// Cells are intrusive lists tagged with a rebuild stamp, so a rebuild is O(n)
+// without clearing the cells and allocates nothing once the buffers have grown.
+// Simulation does not use it: collision is swept inside
+// ObstaclePool::integrate, which touches every obstacle anyway to move it.
+// dodge_bench keeps the grid to compare a rebuild and query with that scan.
+class SpatialGrid {
+public:
+    SpatialGrid();
+    void rebuild(const ObstaclePool& obstacles);
+    void clear();
+
+    bool overlapsRect(float x, float y, float w, float h) const;
+    // Indices (into the pool passed to rebuild) of obstacles overlapping the
+    // rectangle / touching the circle. Results are appended to `result`.
+    void queryRect(float x, float y, float w, float h, std::vector<int>& result) const;
+    void queryRadius(float cx, float cy, float radius, std::vector<int>& result) const;
+
+private:
+    struct Entry {
+        float x, y;
+        int next;
+    };
+
+    int cols, rows;
+    unsigned int stamp;
+    std::vector<unsigned int> cellStamp;
+    std::vector<int> cellHead;
+    std::vector<Entry> entries;
+
+    int cellX(float x) const;
+    int cellY(float y) const;
+    int head(int cell) const;
+};
+
+#endif
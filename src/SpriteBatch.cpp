@@ -0,0 +1,146 @@
+#include "SpriteBatch.h"
+#include <SDL_image.h>
+#include <cmath>
+#include <iostream>
+
+namespace {
+const int ATLAS_WIDTH = 256;
+const int ATLAS_PADDING = 1;
+const SDL_Color WHITE = {255, 255, 255, 255};
+}
+
+SpriteBatch::SpriteBatch() : renderer(nullptr), atlas(nullptr) {}
+
+SpriteBatch::~SpriteBatch() {
+    release();
+}
+
+void SpriteBatch::release() {
+    if (atlas) SDL_DestroyTexture(atlas);
+    atlas = nullptr;
+}
+
+bool SpriteBatch::loadAtlas(SDL_Renderer* targetRenderer, const char* const paths[], int count) {
+    std::vector<SDL_Surface*> images(count, nullptr);
+    bool ok = true;
+    for (int i = 0; i < count && ok; ++i) {
+        images[i] = IMG_Load(paths[i]);
+        if (!images[i]) {
+            std::cerr << "Failed to load " << paths[i] << ": " << SDL_GetError() << std::endl;
+            ok = false;
+        }
+    }
+    if (ok) {
+        ok = buildAtlas(targetRenderer, images.data(), count);
+    }
+    for (SDL_Surface* image : images) {
+        if (image) SDL_FreeSurface(image);
+    }
+    return ok;
+}
+
+bool SpriteBatch::buildAtlas(SDL_Renderer* targetRenderer, SDL_Surface* const images[], int count) {
+    renderer = targetRenderer;
+
+    // Shelf packing: left to right, starting a new row when one is full.
+    std::vector<SDL_Rect> placements(count);
+    int penX = 0, penY = 0, rowHeight = 0;
+    for (int i = 0; i < count; ++i) {
+        if (images[i]->w > ATLAS_WIDTH) {
+            std::cerr << "Sprite " << i << " is wider than the atlas!" << std::endl;
+            return false;
+        }
+        if (penX + images[i]->w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + ATLAS_PADDING;
+            rowHeight = 0;
+        }
+        placements[i] = {penX, penY, images[i]->w, images[i]->h};
+        penX += images[i]->w + ATLAS_PADDING;
+        if (images[i]->h > rowHeight) rowHeight = images[i]->h;
+    }
+    int atlasHeight = penY + rowHeight;
+
+    SDL_Surface* atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, atlasHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlasSurface) {
+        std::cerr << "Failed to create sprite atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_FillRect(atlasSurface, nullptr, 0);
+    regions.resize(count);
+    for (int i = 0; i < count; ++i) {
+        SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(images[i], nullptr, atlasSurface, &placements[i]);
+        regions[i].u0 = static_cast<float>(placements[i].x) / ATLAS_WIDTH;
+        regions[i].v0 = static_cast<float>(placements[i].y) / atlasHeight;
+        regions[i].u1 = static_cast<float>(placements[i].x + placements[i].w) / ATLAS_WIDTH;
+        regions[i].v1 = static_cast<float>(placements[i].y + placements[i].h) / atlasHeight;
+    }
+
+    release();
+    atlas = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+    SDL_FreeSurface(atlasSurface);
+    if (!atlas) {
+        std::cerr << "Failed to upload sprite atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+bool SpriteBatch::isReady() const {
+    return atlas != nullptr;
+}
+
+void SpriteBatch::draw(int sprite, float x, float y, float w, float h) {
+    if (!atlas) {
+        return;
+    }
+    const Region& region = regions[sprite];
+    SDL_Vertex quad[4] = {
+        {{x, y}, WHITE, {region.u0, region.v0}},
+        {{x + w, y}, WHITE, {region.u1, region.v0}},
+        {{x, y + h}, WHITE, {region.u0, region.v1}},
+        {{x + w, y + h}, WHITE, {region.u1, region.v1}},
+    };
+    vertices.insert(vertices.end(), quad, quad + 4);
+}
+
+void SpriteBatch::draw(int sprite, float x, float y, float w, float h, SDL_Color tint, float angle) {
+    if (!atlas) {
+        return;
+    }
+    const Region& region = regions[sprite];
+    float radians = angle * 3.14159265f / 180.0f;
+    float c = std::cos(radians), s = std::sin(radians);
+    float cx = x + w / 2, cy = y + h / 2;
+    float hw = w / 2, hh = h / 2;
+    // Corners relative to the center: (-hw,-hh) (hw,-hh) (-hw,hh) (hw,hh).
+    float ax = -hw * c + hh * s, ay = -hw * s - hh * c;
+    float bx = hw * c + hh * s, by = hw * s - hh * c;
+    SDL_Vertex quad[4] = {
+        {{cx + ax, cy + ay}, tint, {region.u0, region.v0}},
+        {{cx + bx, cy + by}, tint, {region.u1, region.v0}},
+        {{cx - bx, cy - by}, tint, {region.u0, region.v1}},
+        {{cx - ax, cy - ay}, tint, {region.u1, region.v1}},
+    };
+    vertices.insert(vertices.end(), quad, quad + 4);
+}
+
+void SpriteBatch::flush() {
+    int quadCount = static_cast<int>(vertices.size()) / 4;
+    if (quadCount == 0) {
+        return;
+    }
+    for (int q = static_cast<int>(indices.size()) / 6; q < quadCount; ++q) {
+        int base = q * 4;
+        int pattern[6] = {base, base + 1, base + 2, base + 2, base + 1, base + 3};
+        indices.insert(indices.end(), pattern, pattern + 6);
+    }
+    SDL_RenderGeometry(renderer, atlas, vertices.data(), quadCount * 4, indices.data(), quadCount * 6);
+    vertices.clear();
+}
+
+int SpriteBatch::getQueuedCount() const {
+    return static_cast<int>(vertices.size()) / 4;
+}
@@ -0,0 +1,46 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <SDL.h>
+#include <vector>
+
+enum SpriteId { SPRITE_PLAYER, SPRITE_OBSTACLE, SPRITE_LOGO, SPRITE_COUNT };
+
+// Packs the small game sprites into one atlas texture at load time and
+// collects the quads of a frame so they go out as a single
+// SDL_RenderGeometry call on flush(). Tint and rotation are per-vertex data,
+// so they cost no extra draw calls.
+class SpriteBatch {
+public:
+    SpriteBatch();
+    ~SpriteBatch();
+    // The n-th path / surface becomes sprite n. buildAtlas does not take
+    // ownership of the surfaces.
+    bool loadAtlas(SDL_Renderer* renderer, const char* const paths[], int count);
+    bool buildAtlas(SDL_Renderer* renderer, SDL_Surface* const images[], int count);
+    // Frees the atlas; must run before the renderer is destroyed.
+    void release();
+
+    // Whether the atlas exists. Until then draw() and flush() do nothing, so
+    // callers can draw before the threaded loader has delivered the sprites.
+    bool isReady() const;
+
+    void draw(int sprite, float x, float y, float w, float h);
+    // angle is in degrees, clockwise around the sprite center.
+    void draw(int sprite, float x, float y, float w, float h, SDL_Color tint, float angle);
+    void flush();
+    int getQueuedCount() const;
+
+private:
+    struct Region {
+        float u0, v0, u1, v1;
+    };
+
+    SDL_Renderer* renderer;
+    SDL_Texture* atlas;
+    std::vector<Region> regions;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+#endif
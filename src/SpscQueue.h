@@ -0,0 +1,47 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free bounded ring buffer for exactly one producer thread and one
+// consumer thread. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false when the queue is full.
+    bool push(const T& item) {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[currentTail & (Capacity - 1)] = item;
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the queue is empty.
+    bool pop(T& item) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[currentHead & (Capacity - 1)];
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[Capacity];
+    // On separate cache lines so the two threads do not false-share.
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif
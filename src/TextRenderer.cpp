@@ -0,0 +1,204 @@
+#include "TextRenderer.h"
+#include "Constants.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+const int ATLAS_WIDTH = 512;
+const int ATLAS_HEIGHT = 512;
+const int ATLAS_PADDING = 1;
+const int RESERVED_GLYPHS = 128;
+}
+
+TextRenderer::TextRenderer() : renderer(nullptr), atlas(nullptr), glyphs(), lineHeight(0) {}
+
+TextRenderer::~TextRenderer() {
+    release();
+}
+
+void TextRenderer::release() {
+    if (atlas) SDL_DestroyTexture(atlas);
+    atlas = nullptr;
+}
+
+bool TextRenderer::init(SDL_Renderer* targetRenderer, TTF_Font* font) {
+    GlyphMetrics metrics[GLYPH_COUNT];
+    SDL_Surface* atlasSurface = bakeAtlas(font, metrics);
+    if (!atlasSurface) {
+        return false;
+    }
+    bool ok = init(targetRenderer, atlasSurface, metrics);
+    SDL_FreeSurface(atlasSurface);
+    return ok;
+}
+
+SDL_Surface* TextRenderer::bakeAtlas(TTF_Font* font, GlyphMetrics metrics[GLYPH_COUNT]) {
+    SDL_Surface* atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, ATLAS_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlasSurface) {
+        std::cerr << "Failed to create glyph atlas: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    SDL_FillRect(atlasSurface, nullptr, 0);
+
+    SDL_Color white = {255, 255, 255, 255};
+    int penX = 0, penY = 0, rowHeight = 0;
+    for (int c = FIRST_GLYPH; c <= LAST_GLYPH; ++c) {
+        GlyphMetrics& glyph = metrics[c - FIRST_GLYPH];
+        glyph = {0, 0, 0, 0, 0};
+        int minX, maxX, minY, maxY;
+        if (TTF_GlyphMetrics(font, static_cast<Uint16>(c), &minX, &maxX, &minY, &maxY, &glyph.advance) < 0) {
+            glyph.advance = 0;
+        }
+        SDL_Surface* glyphSurface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(c), white);
+        if (!glyphSurface) {
+            continue;
+        }
+        if (penX + glyphSurface->w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + ATLAS_PADDING;
+            rowHeight = 0;
+        }
+        if (penY + glyphSurface->h > ATLAS_HEIGHT) {
+            std::cerr << "Glyph atlas is too small for this font size!" << std::endl;
+            SDL_FreeSurface(glyphSurface);
+            SDL_FreeSurface(atlasSurface);
+            return nullptr;
+        }
+        SDL_Rect dst = {penX, penY, glyphSurface->w, glyphSurface->h};
+        SDL_SetSurfaceBlendMode(glyphSurface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(glyphSurface, nullptr, atlasSurface, &dst);
+
+        glyph.x = penX;
+        glyph.y = penY;
+        glyph.w = glyphSurface->w;
+        glyph.h = glyphSurface->h;
+        penX += glyph.w + ATLAS_PADDING;
+        if (glyph.h > rowHeight) rowHeight = glyph.h;
+        SDL_FreeSurface(glyphSurface);
+    }
+    return atlasSurface;
+}
+
+bool TextRenderer::init(SDL_Renderer* targetRenderer, SDL_Surface* atlasSurface, const GlyphMetrics metrics[GLYPH_COUNT]) {
+    renderer = targetRenderer;
+    release();
+    lineHeight = 0;
+    for (int i = 0; i < GLYPH_COUNT; ++i) {
+        const GlyphMetrics& source = metrics[i];
+        Glyph& glyph = glyphs[i];
+        glyph.w = source.w;
+        glyph.h = source.h;
+        lineHeight = std::max(lineHeight, source.h);
+        glyph.advance = source.advance;
+        glyph.u0 = static_cast<float>(source.x) / atlasSurface->w;
+        glyph.v0 = static_cast<float>(source.y) / atlasSurface->h;
+        glyph.u1 = static_cast<float>(source.x + source.w) / atlasSurface->w;
+        glyph.v1 = static_cast<float>(source.y + source.h) / atlasSurface->h;
+    }
+
+    atlas = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+    if (!atlas) {
+        std::cerr << "Failed to upload glyph atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+
+    layoutQuads.reserve(RESERVED_GLYPHS);
+    vertices.reserve(RESERVED_GLYPHS * 4);
+    indices.reserve(RESERVED_GLYPHS * 6);
+    return true;
+}
+
+const TextRenderer::Glyph& TextRenderer::glyphFor(char c) const {
+    int code = static_cast<unsigned char>(c);
+    if (code < FIRST_GLYPH || code > LAST_GLYPH) {
+        code = '?';
+    }
+    return glyphs[code - FIRST_GLYPH];
+}
+
+int TextRenderer::layout(const char* text, std::vector<Quad>& quads) const {
+    int penX = 0;
+    for (const char* c = text; *c; ++c) {
+        const Glyph& glyph = glyphFor(*c);
+        if (glyph.w > 0) {
+            Quad quad = {static_cast<float>(penX), static_cast<float>(glyph.w), static_cast<float>(glyph.h),
+                         glyph.u0, glyph.v0, glyph.u1, glyph.v1};
+            quads.push_back(quad);
+        }
+        penX += glyph.advance;
+    }
+    return penX;
+}
+
+int TextRenderer::measureText(const char* text) const {
+    int width = 0;
+    for (const char* c = text; *c; ++c) {
+        width += glyphFor(*c).advance;
+    }
+    return width;
+}
+
+void TextRenderer::submit(const Quad* quads, int count, int x, int y, SDL_Color color) {
+    if (count == 0) {
+        return;
+    }
+    // The index pattern never changes, so it is only extended, never rebuilt.
+    for (int q = static_cast<int>(indices.size()) / 6; q < count; ++q) {
+        int base = q * 4;
+        int pattern[6] = {base, base + 1, base + 2, base + 2, base + 1, base + 3};
+        indices.insert(indices.end(), pattern, pattern + 6);
+    }
+    vertices.resize(count * 4);
+    float originY = static_cast<float>(y);
+    for (int q = 0; q < count; ++q) {
+        const Quad& quad = quads[q];
+        float left = x + quad.x;
+        float right = left + quad.w;
+        float bottom = originY + quad.h;
+        SDL_Vertex* v = &vertices[q * 4];
+        v[0] = {{left, originY}, color, {quad.u0, quad.v0}};
+        v[1] = {{right, originY}, color, {quad.u1, quad.v0}};
+        v[2] = {{left, bottom}, color, {quad.u0, quad.v1}};
+        v[3] = {{right, bottom}, color, {quad.u1, quad.v1}};
+    }
+    SDL_RenderGeometry(renderer, atlas, vertices.data(), count * 4, indices.data(), count * 6);
+}
+
+void TextRenderer::renderText(const char* text, int y, SDL_Color color) {
+    renderTextCentered(text, WINDOW_WIDTH / 2, y, color);
+}
+
+void TextRenderer::renderTextCentered(const char* text, int x, int y, SDL_Color color) {
+    layoutQuads.clear();
+    int width = layout(text, layoutQuads);
+    submit(layoutQuads.data(), static_cast<int>(layoutQuads.size()), x - width / 2, y, color);
+}
+
+void TextRenderer::renderTextAt(const char* text, int x, int y, SDL_Color color) {
+    layoutQuads.clear();
+    layout(text, layoutQuads);
+    submit(layoutQuads.data(), static_cast<int>(layoutQuads.size()), x, y, color);
+}
+
+int TextRenderer::cacheText(const char* text) {
+    CachedText cached;
+    cached.firstQuad = static_cast<int>(cachedQuads.size());
+    cached.width = layout(text, cachedQuads);
+    cached.quadCount = static_cast<int>(cachedQuads.size()) - cached.firstQuad;
+    cachedTexts.push_back(cached);
+    return static_cast<int>(cachedTexts.size()) - 1;
+}
+
+void TextRenderer::renderCached(int id, int y, SDL_Color color) {
+    renderCachedCentered(id, WINDOW_WIDTH / 2, y, color);
+}
+
+void TextRenderer::renderCachedCentered(int id, int x, int y, SDL_Color color) {
+    const CachedText& cached = cachedTexts[id];
+    submit(cachedQuads.data() + cached.firstQuad, cached.quadCount, x - cached.width / 2, y, color);
+}
+
+int TextRenderer::getLineHeight() const {
+    return lineHeight;
+}
@@ -0,0 +1,84 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <vector>
+
+// Draws text from a glyph atlas rasterized once from the font. Every string is
+// a single SDL_RenderGeometry call, and strings registered with cacheText()
+// skip layout too. After init() no surfaces or textures are created, and the
+// vertex buffers only grow for strings longer than any seen before. Strings
+// are plain C strings, so callers can format into stack buffers.
+class TextRenderer {
+public:
+    static const int FIRST_GLYPH = 32;
+    static const int LAST_GLYPH = 126;
+    static const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+
+    // Where a glyph sits in the atlas surface, in pixels.
+    struct GlyphMetrics {
+        int x, y, w, h;
+        int advance;
+    };
+
+    TextRenderer();
+    ~TextRenderer();
+    bool init(SDL_Renderer* renderer, TTF_Font* font);
+    // Uploads an atlas made by bakeAtlas (possibly in an earlier run, see dodge_pack).
+    bool init(SDL_Renderer* renderer, SDL_Surface* atlasSurface, const GlyphMetrics metrics[GLYPH_COUNT]);
+    // Rasterizes FIRST_GLYPH..LAST_GLYPH into a new RGBA32 surface owned by the caller.
+    static SDL_Surface* bakeAtlas(TTF_Font* font, GlyphMetrics metrics[GLYPH_COUNT]);
+    // Frees the atlas; must run before the renderer is destroyed.
+    void release();
+
+    // Centered horizontally on the window.
+    void renderText(const char* text, int y, SDL_Color color);
+    // Centered horizontally on x.
+    void renderTextCentered(const char* text, int x, int y, SDL_Color color);
+    // Left-aligned at x.
+    void renderTextAt(const char* text, int x, int y, SDL_Color color);
+
+    // Lays out a string once and returns a handle for the renderCached* calls.
+    int cacheText(const char* text);
+    void renderCached(int id, int y, SDL_Color color);
+    void renderCachedCentered(int id, int x, int y, SDL_Color color);
+
+    int measureText(const char* text) const;
+    // Height of the tallest glyph; every string fits in [y, y + line height).
+    int getLineHeight() const;
+
+private:
+    struct Glyph {
+        float u0, v0, u1, v1;
+        int w, h;
+        int advance;
+    };
+
+    struct Quad {
+        float x, w, h;
+        float u0, v0, u1, v1;
+    };
+
+    struct CachedText {
+        int firstQuad;
+        int quadCount;
+        int width;
+    };
+
+    SDL_Renderer* renderer;
+    SDL_Texture* atlas;
+    Glyph glyphs[GLYPH_COUNT];
+    int lineHeight;
+    std::vector<Quad> layoutQuads;
+    std::vector<Quad> cachedQuads;
+    std::vector<CachedText> cachedTexts;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    const Glyph& glyphFor(char c) const;
+    int layout(const char* text, std::vector<Quad>& quads) const;
+    void submit(const Quad* quads, int count, int x, int y, SDL_Color color);
+};
+
+#endif
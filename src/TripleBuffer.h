@@ -0,0 +1,55 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-writer/single-reader triple buffer. The writer fills
+// getWriteBuffer() and publishes it; the reader calls update() and then reads
+// getReadBuffer(), which stays untouched until its next update(). Neither side
+// ever waits, and the reader only ever sees the newest complete buffer.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side.
+    T& getWriteBuffer() {
+        return buffers[writeIndex];
+    }
+    // Hands the write buffer to the reader and takes the spare one back. The
+    // new write buffer holds an older value and must be fully overwritten.
+    void publish() {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(writeIndex | FRESH), std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side. Returns false (and keeps the current buffer) when nothing
+    // was published since the last call.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(readIndex), std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+    const T& getReadBuffer() const {
+        return buffers[readIndex];
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t FRESH = 4;
+
+    T buffers[3];
+    // Index of the spare buffer, with FRESH set when it holds a value the
+    // reader has not taken yet.
+    std::atomic<uint8_t> middle;
+    uint8_t writeIndex;
+    uint8_t readIndex;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "UdpSocket.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+namespace {
+const uintptr_t NO_SOCKET = INVALID_SOCKET;
+
+// Winsock is started with the first socket and left running.
+bool startNetworking() {
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+    return started;
+}
+
+bool wouldBlock() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+int closeSocket(uintptr_t handle) {
+    return closesocket(handle);
+}
+}
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+namespace {
+const int NO_SOCKET = -1;
+
+bool startNetworking() {
+    return true;
+}
+
+bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+int closeSocket(int handle) {
+    return ::close(handle);
+}
+}
+#endif
+
+namespace {
+sockaddr_in toSockaddr(const NetAddress& address) {
+    sockaddr_in result;
+    std::memset(&result, 0, sizeof(result));
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(address.host);
+    result.sin_port = htons(address.port);
+    return result;
+}
+}
+
+bool operator==(const NetAddress& a, const NetAddress& b) {
+    return a.host == b.host && a.port == b.port;
+}
+
+bool parseNetAddress(const std::string& text, NetAddress& address) {
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon == 0 || !startNetworking()) {
+        return false;
+    }
+    int port = std::atoi(text.c_str() + colon + 1);
+    if (port <= 0 || port > 65535) {
+        return false;
+    }
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(text.substr(0, colon).c_str(), nullptr, &hints, &found) != 0 || !found) {
+        return false;
+    }
+    address.host = ntohl(reinterpret_cast<sockaddr_in*>(found->ai_addr)->sin_addr.s_addr);
+    address.port = static_cast<uint16_t>(port);
+    freeaddrinfo(found);
+    return true;
+}
+
+std::string formatNetAddress(const NetAddress& address) {
+    return std::to_string(address.host >> 24) + "." + std::to_string((address.host >> 16) & 0xFF) + "." +
+           std::to_string((address.host >> 8) & 0xFF) + "." + std::to_string(address.host & 0xFF) + ":" +
+           std::to_string(address.port);
+}
+
+UdpSocket::UdpSocket() : handle(NO_SOCKET), localPort(0) {}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+bool UdpSocket::open(uint16_t port) {
+    close();
+    if (!startNetworking()) {
+        std::cerr << "Failed to start networking" << std::endl;
+        return false;
+    }
+    handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == NO_SOCKET) {
+        std::cerr << "Failed to create UDP socket" << std::endl;
+        return false;
+    }
+    NetAddress any = {INADDR_ANY, port};
+    sockaddr_in local = toSockaddr(any);
+    if (bind(handle, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        std::cerr << "Failed to bind UDP port " << port << std::endl;
+        close();
+        return false;
+    }
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    bool ok = ioctlsocket(handle, FIONBIO, &nonBlocking) == 0;
+#else
+    bool ok = fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ok) {
+        std::cerr << "Failed to make the UDP socket non-blocking" << std::endl;
+        close();
+        return false;
+    }
+    socklen_t length = sizeof(local);
+    getsockname(handle, reinterpret_cast<sockaddr*>(&local), &length);
+    localPort = ntohs(local.sin_port);
+    return true;
+}
+
+void UdpSocket::close() {
+    if (handle != NO_SOCKET) {
+        closeSocket(handle);
+        handle = NO_SOCKET;
+    }
+    localPort = 0;
+}
+
+bool UdpSocket::isOpen() const {
+    return handle != NO_SOCKET;
+}
+
+uint16_t UdpSocket::getLocalPort() const {
+    return localPort;
+}
+
+bool UdpSocket::sendTo(const NetAddress& to, const uint8_t* data, size_t size) {
+    sockaddr_in target = toSockaddr(to);
+    int sent = sendto(handle, reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+                      reinterpret_cast<sockaddr*>(&target), sizeof(target));
+    return sent == static_cast<int>(size);
+}
+
+int UdpSocket::receiveFrom(NetAddress& from, uint8_t* buffer, size_t capacity) {
+    sockaddr_in source;
+    socklen_t length = sizeof(source);
+    int received = recvfrom(handle, reinterpret_cast<char*>(buffer), static_cast<int>(capacity), 0,
+                            reinterpret_cast<sockaddr*>(&source), &length);
+    if (received < 0) {
+        return wouldBlock() ? 0 : -1;
+    }
+    from.host = ntohl(source.sin_addr.s_addr);
+    from.port = ntohs(source.sin_port);
+    return received;
+}
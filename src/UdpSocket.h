@@ -0,0 +1,47 @@
+#ifndef UDP_SOCKET_H
+#define UDP_SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// IPv4 address and port, both in host byte order.
+struct NetAddress {
+    uint32_t host;
+    uint16_t port;
+};
+
+bool operator==(const NetAddress& a, const NetAddress& b);
+// "host:port"; the host is resolved (localhost, a name or a dotted quad).
+bool parseNetAddress(const std::string& text, NetAddress& address);
+std::string formatNetAddress(const NetAddress& address);
+
+// Non-blocking IPv4 UDP socket (BSD sockets, or Winsock on Windows).
+class UdpSocket {
+public:
+    UdpSocket();
+    ~UdpSocket();
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    // Binds every interface on `port`; 0 picks a free one.
+    bool open(uint16_t port);
+    void close();
+    bool isOpen() const;
+    uint16_t getLocalPort() const;
+
+    bool sendTo(const NetAddress& to, const uint8_t* data, size_t size);
+    // Size of the datagram read into `buffer` (cut to `capacity`), 0 when
+    // none is waiting and -1 on error.
+    int receiveFrom(NetAddress& from, uint8_t* buffer, size_t capacity);
+
+private:
+#ifdef _WIN32
+    uintptr_t handle;
+#else
+    int handle;
+#endif
+    uint16_t localPort;
+};
+
+#endif
@@ -1,24 +0,0 @@
-#include "Utils.h"
-#include "Constants.h"
-
-void renderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, int y, SDL_Color color) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    int textWidth, textHeight;
-    TTF_SizeText(font, text.c_str(), &textWidth, &textHeight);
-    SDL_Rect dst = {(WINDOW_WIDTH - textWidth) / 2, y, textWidth, textHeight};
-    SDL_RenderCopy(renderer, texture, nullptr, &dst);
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-}
-
-void renderTextCentered(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, int x, int y, SDL_Color color) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    int textWidth, textHeight;
-    TTF_SizeText(font, text.c_str(), &textWidth, &textHeight);
-    SDL_Rect dst = {x - textWidth / 2, y, textWidth, textHeight};
-    SDL_RenderCopy(renderer, texture, nullptr, &dst);
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-}
@@ -0,0 +1,52 @@
+#include "WeatherSystem.h"
+#include "Constants.h"
+#include "FrameArena.h"
+#include <SDL.h>
+#include <algorithm>
+
+namespace {
+const int RAIN_BATCH_SIZE = 4096;
+}
+
+void WeatherSystem::renderWeather(SDL_Renderer* renderer, FrameArena& arena) const {
+    if (currentWeather == WeatherEffect::FOG) {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 100);
+        SDL_Rect fogRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+        SDL_RenderFillRect(renderer, &fogRect);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    } else if (currentWeather == WeatherEffect::RAIN) {
+        // Drops are vertical 1 px lines, so they go out as batches of thin
+        // rects built in the frame's arena (one batch unless the rain was
+        // made heavier than the default).
+        int batchSize = std::min(rainCount, RAIN_BATCH_SIZE);
+        SDL_Rect* rects = arena.allocate<SDL_Rect>(batchSize);
+        if (!rects) {
+            return;
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 255, 150);
+        int rectCount = 0;
+        int capacity = static_cast<int>(rainDrops.size());
+        int firstSpan = std::min(rainCount, capacity - rainHead);
+        auto addDrop = [&](const RainDrop& drop) {
+            if (drop.y <= WINDOW_HEIGHT) {
+                rects[rectCount++] = {static_cast<int>(drop.x), static_cast<int>(drop.y), 1, drop.length + 1};
+                if (rectCount == batchSize) {
+                    SDL_RenderFillRects(renderer, rects, rectCount);
+                    rectCount = 0;
+                }
+            }
+        };
+        for (int i = rainHead; i < rainHead + firstSpan; ++i) {
+            addDrop(rainDrops[i]);
+        }
+        for (int i = 0; i < rainCount - firstSpan; ++i) {
+            addDrop(rainDrops[i]);
+        }
+        if (rectCount > 0) {
+            SDL_RenderFillRects(renderer, rects, rectCount);
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    }
+}
@@ -1,60 +1,206 @@
 #include "WeatherSystem.h"
 #include "Constants.h"
-#include <cstdlib>
+#include "JobSystem.h"
+#include "SaveFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const uint64_t WEATHER_STREAM = 2;
+const uint64_t PARTICLE_STREAM = 3;
+const int PARALLEL_CHUNK = 16384;
+}
+
+const char* getWeatherName(WeatherEffect effect) {
+    switch (effect) {
+        case WeatherEffect::RAIN: return "rain";
+        case WeatherEffect::FOG: return "fog";
+        default: return "none";
+    }
+}
+
+bool parseWeatherName(const char* name, WeatherEffect& effect) {
+    for (WeatherEffect candidate : {WeatherEffect::NONE, WeatherEffect::RAIN, WeatherEffect::FOG}) {
+        if (std::strcmp(name, getWeatherName(candidate)) == 0) {
+            effect = candidate;
+            return true;
+        }
+    }
+    return false;
+}
 
 WeatherSystem::WeatherSystem()
-    : currentWeather(WeatherEffect::NONE), weatherStartTime(0), weatherDuration(0), lastWeatherChange(0) {}
+    : currentWeather(WeatherEffect::NONE), weatherStartTime(0), weatherDuration(0), lastWeatherChange(0),
+      weatherForced(false), forcedWeather(WeatherEffect::NONE),
+      weatherRandom(1, WEATHER_STREAM), particleRandom(1, PARTICLE_STREAM), jobs(nullptr),
+      rainDropsPerSecond(RAIN_DROPS_PER_SECOND), rainSpawnAccumulator(0),
+      rainDrops(RAIN_MAX_DROPS), rainHead(0), rainCount(0) {}
+
+void WeatherSystem::reset() {
+    currentWeather = weatherForced ? forcedWeather : WeatherEffect::NONE;
+    weatherStartTime = 0;
+    weatherDuration = 0;
+    lastWeatherChange = 0;
+    clearRain();
+}
+
+void WeatherSystem::setJobSystem(JobSystem* newJobs) {
+    jobs = newJobs;
+}
+
+void WeatherSystem::setRainIntensity(float dropsPerSecond, int maxDrops) {
+    rainDropsPerSecond = dropsPerSecond;
+    rainDrops.assign(maxDrops > 0 ? maxDrops : 1, RainDrop());
+    clearRain();
+}
 
-void WeatherSystem::updateWeather(Uint32 currentTime, bool isClassicMode) {
-    Uint32 elapsedTime = currentTime - lastWeatherChange;
-    int weatherInterval = isClassicMode ? CLASSIC_WEATHER_INTERVAL : SURVIVAL_WEATHER_INTERVAL;
+void WeatherSystem::setForcedWeather(WeatherEffect effect) {
+    weatherForced = true;
+    forcedWeather = effect;
+    if (currentWeather != effect) {
+        currentWeather = effect;
+        clearRain();
+    }
+}
 
-    if (elapsedTime >= weatherInterval) {
+void WeatherSystem::clearForcedWeather() {
+    weatherForced = false;
+}
+
+void WeatherSystem::seedRandom(uint64_t seed) {
+    weatherRandom.seed(seed, WEATHER_STREAM);
+    particleRandom.seed(seed, PARTICLE_STREAM);
+}
+
+void WeatherSystem::clearRain() {
+    rainHead = 0;
+    rainCount = 0;
+    rainSpawnAccumulator = 0;
+}
+
+void WeatherSystem::updateWeather(uint32_t currentTime, uint32_t interval, uint32_t duration, float dt) {
+    uint32_t elapsedTime = currentTime - lastWeatherChange;
+
+    if (!weatherForced && elapsedTime >= interval) {
         if (currentWeather != WeatherEffect::NONE && (currentTime - weatherStartTime) >= weatherDuration) {
             currentWeather = WeatherEffect::NONE;
-            rainDrops.clear();
+            clearRain();
             lastWeatherChange = currentTime;
             return;
         }
 
         if (currentWeather == WeatherEffect::NONE) {
-            int weatherType = rand() % 2;
+            int weatherType = weatherRandom.nextInt(2);
             currentWeather = (weatherType == 0) ? WeatherEffect::RAIN : WeatherEffect::FOG;
             weatherStartTime = currentTime;
-            weatherDuration = isClassicMode ? CLASSIC_WEATHER_DURATION : SURVIVAL_WEATHER_DURATION;
+            weatherDuration = duration;
             lastWeatherChange = currentTime;
         }
     }
 
-    if (currentWeather == WeatherEffect::RAIN && rand() % 10 == 0) {
-        rainDrops.push_back(spawnRainDrop());
+    int capacity = static_cast<int>(rainDrops.size());
+    if (currentWeather == WeatherEffect::RAIN) {
+        rainSpawnAccumulator += rainDropsPerSecond * dt / 1000.0f;
+        while (rainSpawnAccumulator >= 1.0f) {
+            rainSpawnAccumulator -= 1.0f;
+            if (rainCount == capacity) {
+                rainHead = (rainHead + 1) % capacity;
+                --rainCount;
+            }
+            rainDrops[(rainHead + rainCount) % capacity] = spawnRainDrop(particleRandom);
+            ++rainCount;
+        }
     }
 
-    for (auto it = rainDrops.begin(); it != rainDrops.end();) {
-        it->y += it->speed;
-        if (it->y > WINDOW_HEIGHT) {
-            it = rainDrops.erase(it);
-        } else {
-            ++it;
+    // [begin, end) counts from the oldest drop; the ring may wrap inside it.
+    float frames = dt / SIM_FRAME_MS;
+    auto fall = [this, capacity, frames](int, int begin, int end) {
+        int first = rainHead + begin;
+        int last = rainHead + end;
+        for (int i = first; i < std::min(last, capacity); ++i) {
+            rainDrops[i].y += rainDrops[i].speed * frames;
         }
+        for (int i = std::max(first, capacity) - capacity; i < last - capacity; ++i) {
+            rainDrops[i].y += rainDrops[i].speed * frames;
+        }
+    };
+    if (jobs) {
+        jobs->parallelFor(rainCount, PARALLEL_CHUNK, fall);
+    } else {
+        fall(0, 0, rainCount);
+    }
+    while (rainCount > 0 && rainDrops[rainHead].y > WINDOW_HEIGHT) {
+        rainHead = (rainHead + 1) % capacity;
+        --rainCount;
+    }
+}
+
+void WeatherSystem::save(SaveWriter& writer) const {
+    writer.writeI32(static_cast<int32_t>(currentWeather));
+    writer.writeU32(weatherStartTime);
+    writer.writeU32(weatherDuration);
+    writer.writeU32(lastWeatherChange);
+    writer.writeF32(rainSpawnAccumulator);
+    writer.writeI32(rainCount);
+    int capacity = static_cast<int>(rainDrops.size());
+    for (int i = 0; i < rainCount; ++i) {
+        const RainDrop& drop = rainDrops[(rainHead + i) % capacity];
+        writer.writeF32(drop.x);
+        writer.writeF32(drop.y);
+        writer.writeF32(drop.speed);
+        writer.writeI32(drop.length);
     }
 }
 
-void WeatherSystem::renderWeather(SDL_Renderer* renderer) {
-    if (currentWeather == WeatherEffect::FOG) {
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 100);
-        SDL_Rect fogRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-        SDL_RenderFillRect(renderer, &fogRect);
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-    } else if (currentWeather == WeatherEffect::RAIN) {
-        SDL_SetRenderDrawColor(renderer, 0, 0, 255, 150);
-        for (const auto& drop : rainDrops) {
-            SDL_RenderDrawLine(renderer, drop.x, drop.y, drop.x, drop.y + drop.length);
+bool WeatherSystem::load(SaveReader& reader) {
+    int32_t effect = reader.readI32();
+    if (effect < static_cast<int32_t>(WeatherEffect::NONE) || effect > static_cast<int32_t>(WeatherEffect::FOG)) {
+        return false;
+    }
+    currentWeather = static_cast<WeatherEffect>(effect);
+    weatherStartTime = reader.readU32();
+    weatherDuration = reader.readU32();
+    lastWeatherChange = reader.readU32();
+    rainSpawnAccumulator = reader.readF32();
+    int savedCount = reader.readI32();
+    if (savedCount < 0 || reader.remaining() < static_cast<size_t>(savedCount) * 16) {
+        return false;
+    }
+    // Keep the newest drops if the ring is smaller than the one that saved.
+    int capacity = static_cast<int>(rainDrops.size());
+    int skipped = std::max(0, savedCount - capacity);
+    rainHead = 0;
+    rainCount = 0;
+    for (int i = 0; i < savedCount; ++i) {
+        RainDrop drop;
+        drop.x = reader.readF32();
+        drop.y = reader.readF32();
+        drop.speed = reader.readF32();
+        drop.length = reader.readI32();
+        if (i >= skipped) {
+            rainDrops[rainCount++] = drop;
         }
     }
+    if (weatherForced) {
+        currentWeather = forcedWeather;
+    }
+    return !reader.failed();
+}
+
+void WeatherSystem::saveRandomState(SaveWriter& writer) const {
+    writer.writeU64(weatherRandom.getState());
+    writer.writeU64(particleRandom.getState());
+}
+
+void WeatherSystem::loadRandomState(SaveReader& reader) {
+    weatherRandom.setState(reader.readU64());
+    particleRandom.setState(reader.readU64());
 }
 
 WeatherEffect WeatherSystem::getCurrentWeather() const {
     return currentWeather;
 }
+
+int WeatherSystem::getRainDropCount() const {
+    return rainCount;
+}
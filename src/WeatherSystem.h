@@ -2,24 +2,72 @@
 #define WEATHER_SYSTEM_H
 
 #include "GameObject.h"
+#include "Random.h"
+#include <cstdint>
 #include <vector>
-#include <SDL.h>
+
+struct SDL_Renderer;
+class FrameArena;
+class JobSystem;
+class SaveReader;
+class SaveWriter;
 
 enum class WeatherEffect { NONE, RAIN, FOG };
 
+// "none", "rain" or "fog", as on the command line.
+const char* getWeatherName(WeatherEffect effect);
+// False if `name` is none of those.
+bool parseWeatherName(const char* name, WeatherEffect& effect);
+
 class WeatherSystem {
 public:
     WeatherSystem();
-    void updateWeather(Uint32 currentTime, bool isClassicMode);
-    void renderWeather(SDL_Renderer* renderer);
+    // Clears the current weather and drops but keeps the rain settings.
+    void reset();
+    // Rain spawn rate and the size of the drop ring buffer. When the buffer is
+    // full the oldest drop is overwritten.
+    void setRainIntensity(float dropsPerSecond, int maxDrops);
+    // Pins the weather to one effect until clearForcedWeather(); survives reset().
+    void setForcedWeather(WeatherEffect effect);
+    void clearForcedWeather();
+    // Seeds the weather-change and rain-drop generators (separate streams).
+    void seedRandom(uint64_t seed);
+    // Optional; drops then fall in parallel chunks once there are enough. Not owned.
+    void setJobSystem(JobSystem* jobs);
+    // Outside forced weather, a random effect starts `interval` ms after the
+    // last change and lasts `duration` ms (the mode's weather cadence).
+    void updateWeather(uint32_t currentTime, uint32_t interval, uint32_t duration, float dt);
+    // Defined in WeatherRenderer.cpp so the simulation library stays free of
+    // SDL. The rain's rects come from the frame's arena.
+    void renderWeather(SDL_Renderer* renderer, FrameArena& arena) const;
+    // Current effect, its timers and the live drops (oldest first). Rain
+    // settings and forced weather are configuration and are not saved.
+    void save(SaveWriter& writer) const;
+    bool load(SaveReader& reader);
+    void saveRandomState(SaveWriter& writer) const;
+    void loadRandomState(SaveReader& reader);
     WeatherEffect getCurrentWeather() const;
+    int getRainDropCount() const;
 
 private:
     WeatherEffect currentWeather;
-    Uint32 weatherStartTime;
-    Uint32 weatherDuration;
-    Uint32 lastWeatherChange;
+    uint32_t weatherStartTime;
+    uint32_t weatherDuration;
+    uint32_t lastWeatherChange;
+    bool weatherForced;
+    WeatherEffect forcedWeather;
+    Random weatherRandom;
+    Random particleRandom;
+    JobSystem* jobs;
+    float rainDropsPerSecond;
+    float rainSpawnAccumulator;
+    // Ring buffer: live drops are rainHead .. rainHead + rainCount (wrapping).
+    // Drops that fell off screen stay in place until the head passes them.
     std::vector<RainDrop> rainDrops;
+    int rainHead;
+    int rainCount;
+
+    void clearRain();
 };
 
 #endif
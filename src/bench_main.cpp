@@ -0,0 +1,433 @@
+#include "AutoPilot.h"
+#include "Collision.h"
+#include "Constants.h"
+#include "GameObject.h"
+#include "JobSystem.h"
+#include "ObstaclePool.h"
+#include "Random.h"
+#include "Simulation.h"
+#include "SpatialGrid.h"
+#include "WeatherSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef DODGE_BENCH_SDL
+#include "TextRenderer.h"
+#include <SDL.h>
+#include <SDL_ttf.h>
+#endif
+
+// Microbenchmarks for the simulation kernels (and text drawing when built
+// with SDL). Every benchmark is run for N = 10, 100, ... up to --max-n and
+// reports nanoseconds per processed item, so runs from different commits can
+// be diffed from the CSV/JSON output.
+namespace {
+const char* SAVE_PATH = "dodge_bench_save.tmp";
+const char* LEGACY_SAVE_PATH = "dodge_bench_save_text.tmp";
+
+struct BenchResult {
+    std::string name;
+    int n;
+    long long items;      // items processed per iteration (may be capped below n)
+    long long iterations;
+    double totalMs;
+    double nsPerItem;
+};
+
+struct BenchOptions {
+    int maxN = 1000000;
+    double minTimeMs = 200;
+    std::string filter;
+    std::string csvPath;
+    std::string jsonPath;
+};
+
+Random benchRandom(1);
+// Every hardware thread; used by the *_parallel variants.
+JobSystem benchJobs;
+
+// A player standing in the corner, for the obstacle update benchmarks.
+const SweptRect CORNER_PLAYER = {0, 0, 0, 0, PLAYER_WIDTH, PLAYER_HEIGHT};
+
+// Keeps results of the measured code observable so it is not optimized away.
+volatile long long benchSink = 0;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs `body` (which returns the number of items it processed) once to warm
+// up, then doubles the iteration count until a batch takes at least minTimeMs.
+BenchResult measure(const std::string& name, int n, double minTimeMs, const std::function<long long()>& body) {
+    long long items = body();
+    long long iterations = 1;
+    double totalMs = 0;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; ++i) {
+            benchSink = benchSink + body();
+        }
+        totalMs = elapsedMs(start);
+        if (totalMs >= minTimeMs || iterations >= (1LL << 30)) {
+            break;
+        }
+        iterations *= 2;
+    }
+    double nsPerItem = items > 0 ? totalMs * 1e6 / (static_cast<double>(iterations) * items) : 0;
+    return {name, n, items, iterations, totalMs, nsPerItem};
+}
+
+float randomFloat(float low, float high) {
+    return low + (high - low) * (benchRandom.next() / 4294967296.0f);
+}
+
+// Obstacles scattered over the playfield, moving in the four spawn directions.
+void fillPlayfield(ObstaclePool& pool, int n) {
+    pool.clear();
+    for (int i = 0; i < n; ++i) {
+        GameObject obj = spawnObject(INITIAL_OBJECT_SPEED, benchRandom);
+        obj.x = randomFloat(0, WINDOW_WIDTH - OBJECT_SIZE);
+        obj.y = randomFloat(0, WINDOW_HEIGHT - OBJECT_SIZE);
+        pool.add(obj);
+    }
+}
+
+void benchSpawnObject(int n, const BenchOptions& options, std::vector<BenchResult>& results) {
+    ObstaclePool pool(n);
+    results.push_back(measure("spawn_object", n, options.minTimeMs, [&]() -> long long {
+        pool.clear();
+        for (int i = 0; i < n; ++i) {
+            pool.add(spawnObject(INITIAL_OBJECT_SPEED, benchRandom));
+        }
+        return pool.size();
+    }));
+}
+
+void benchCollision(int n, const BenchOptions& options, std::vector<BenchResult>& results) {
+    ObstaclePool pool(n);
+    fillPlayfield(pool, n);
+    const float playerX = (WINDOW_WIDTH - PLAYER_WIDTH) / 2.0f;
+    const float playerY = (WINDOW_HEIGHT - PLAYER_HEIGHT) / 2.0f;
+
+    // One checkCollision call per obstacle, as the original per-object loop did.
+    results.push_back(measure("check_collision", n, options.minTimeMs, [&]() -> long long {
+        const float* xs = pool.getX();
+        const float* ys = pool.getY();
+        long long hits = 0;
+        for (int i = 0; i < pool.size(); ++i) {
+            hits += Simulation::checkCollision(playerX, playerY, PLAYER_WIDTH, PLAYER_HEIGHT,
+                                               xs[i], ys[i], OBJECT_SIZE, OBJECT_SIZE);
+        }
+        benchSink = benchSink + hits;
+        return pool.size();
+    }));
+
+    // The exact swept test on every obstacle (the simulation only runs it on
+    // broad-phase candidates), with the player walking one tick's distance.
+    SweptRect player = {playerX, playerY, playerX + PLAYER_SPEED, playerY + PLAYER_SPEED, PLAYER_WIDTH, PLAYER_HEIGHT};
+    results.push_back(measure("swept_collision", n, options.minTimeMs, [&]() -> long long {
+        const float* xs = pool.getX();
+        const float* ys = pool.getY();
+        const float* dxs = pool.getDX();
+        const float* dys = pool.getDY();
+        long long hits = 0;
+        for (int i = 0; i < pool.size(); ++i) {
+            SweptRect obstacle = {xs[i], ys[i], xs[i] + dxs[i], ys[i] + dys[i], OBJECT_SIZE, OBJECT_SIZE};
+            hits += sweptCollisionTime(player, obstacle) >= 0.0f;
+        }
+        benchSink = benchSink + hits;
+        return pool.size();
+    }));
+
+    SpatialGrid grid;
+    results.push_back(measure("grid_rebuild_query", n, options.minTimeMs, [&]() -> long long {
+        grid.rebuild(pool);
+        benchSink = benchSink + grid.overlapsRect(playerX, playerY, PLAYER_WIDTH, PLAYER_HEIGHT);
+        return pool.size();
+    }));
+}
+
+void benchObstacleUpdate(int n, const BenchOptions& options, std::vector<BenchResult>& results) {
+    ObstaclePool pool(n);
+    fillPlayfield(pool, n);
+    // Alternating the direction keeps every obstacle near its start, so the
+    // pool stays at n and each iteration does the same work.
+    float frames = 1.0f;
+    results.push_back(measure("obstacle_update", n, options.minTimeMs, [&]() -> long long {
+        benchSink = benchSink + pool.integrate(frames, CORNER_PLAYER);
+        frames = -frames;
+        return pool.size();
+    }));
+    results.push_back(measure("obstacle_update_parallel", n, options.minTimeMs, [&]() -> long long {
+        benchSink = benchSink + pool.integrate(benchJobs, frames, CORNER_PLAYER);
+        frames = -frames;
+        return pool.size();
+    }));
+
+    // Half of the obstacles leave the playfield on the first step and are
+    // removed; the pool is refilled from a copy each iteration. The copy is
+    // timed on its own and taken out of the update's result.
+    ObstaclePool source(n);
+    for (int i = 0; i < n; ++i) {
+        GameObject obj = spawnObject(INITIAL_OBJECT_SPEED, benchRandom);
+        obj.x = randomFloat(0, WINDOW_WIDTH - OBJECT_SIZE);
+        obj.y = (i % 2) ? WINDOW_HEIGHT - 1.0f : WINDOW_HEIGHT / 2.0f;
+        obj.dx = 0;
+        obj.dy = INITIAL_OBJECT_SPEED;
+        source.add(obj);
+    }
+    BenchResult copy = measure("obstacle_pool_copy", n, options.minTimeMs, [&]() -> long long {
+        pool = source;
+        benchSink = benchSink + pool.size();
+        return n;
+    });
+    BenchResult cull = measure("obstacle_update_cull", n, options.minTimeMs, [&]() -> long long {
+        pool = source;
+        benchSink = benchSink + pool.integrate(1.0f, CORNER_PLAYER);
+        return n;
+    });
+    double copyMs = copy.nsPerItem * cull.iterations * cull.items / 1e6;
+    cull.totalMs = std::max(cull.totalMs - copyMs, 0.0);
+    cull.nsPerItem = std::max(cull.nsPerItem - copy.nsPerItem, 0.0);
+    results.push_back(copy);
+    results.push_back(cull);
+}
+
+void benchWeather(int n, const BenchOptions& options, std::vector<BenchResult>& results) {
+    WeatherSystem weather;
+    weather.setRainIntensity(n * 2.0f, n);
+    weather.setForcedWeather(WeatherEffect::RAIN);
+    uint32_t now = 0;
+    // Spawn rate exceeds the capacity, so the ring fills and stays full.
+    for (int i = 0; i < 1000 && weather.getRainDropCount() < n; ++i) {
+        weather.updateWeather(now, ClassicMode::WEATHER_INTERVAL, ClassicMode::WEATHER_DURATION, SIM_FRAME_MS);
+        now += static_cast<uint32_t>(SIM_FRAME_MS);
+    }
+    results.push_back(measure("weather_update", n, options.minTimeMs, [&]() -> long long {
+        weather.updateWeather(now, ClassicMode::WEATHER_INTERVAL, ClassicMode::WEATHER_DURATION, SIM_FRAME_MS);
+        now += static_cast<uint32_t>(SIM_FRAME_MS);
+        return weather.getRainDropCount();
+    }));
+    weather.setJobSystem(&benchJobs);
+    results.push_back(measure("weather_update_parallel", n, options.minTimeMs, [&]() -> long long {
+        weather.updateWeather(now, ClassicMode::WEATHER_INTERVAL, ClassicMode::WEATHER_DURATION, SIM_FRAME_MS);
+        now += static_cast<uint32_t>(SIM_FRAME_MS);
+        return weather.getRainDropCount();
+    }));
+}
+
+// A text save with the player in the middle and up to MAX_OBSTACLES
+// obstacles scattered over the playfield.
+void writeLegacySave(int n) {
+    std::ofstream outFile(LEGACY_SAVE_PATH);
+    outFile << (WINDOW_WIDTH - PLAYER_WIDTH) / 2 << " " << (WINDOW_HEIGHT - PLAYER_HEIGHT) / 2 << "\n";
+    outFile << 60000 << "\n" << 60 << "\n";
+    int count = std::min(n, MAX_OBSTACLES);
+    outFile << count << "\n";
+    for (int i = 0; i < count; ++i) {
+        GameObject obj = spawnObject(INITIAL_OBJECT_SPEED, benchRandom);
+        outFile << randomFloat(0, WINDOW_WIDTH) << " " << randomFloat(0, WINDOW_HEIGHT) << " "
+                << obj.dx << " " << obj.dy << "\n";
+    }
+}
+
+// The simulation's pool holds at most MAX_OBSTACLES, so larger N are capped
+// (the `items` column shows how many were actually written/read).
+void benchSavegame(int n, const BenchOptions& options, std::vector<BenchResult>& results) {
+    writeLegacySave(n);
+    Simulation simulation;
+    if (!simulation.loadState(LEGACY_SAVE_PATH)) {
+        return;
+    }
+    results.push_back(measure("savegame_parse_text", n, options.minTimeMs, [&]() -> long long {
+        simulation.loadState(LEGACY_SAVE_PATH);
+        return simulation.getObstacles().size();
+    }));
+    results.push_back(measure("savegame_serialize", n, options.minTimeMs, [&]() -> long long {
+        simulation.saveState(SAVE_PATH);
+        return simulation.getObstacles().size();
+    }));
+    results.push_back(measure("savegame_parse", n, options.minTimeMs, [&]() -> long long {
+        simulation.loadState(SAVE_PATH);
+        return simulation.getObstacles().size();
+    }));
+    std::remove(SAVE_PATH);
+    std::remove(LEGACY_SAVE_PATH);
+}
+
+// One AutoPilot decision with N obstacles on screen (capped like the save);
+// ns/item is the cost per decision, which has to fit in a tick.
+void benchAutoPilot(int n, const BenchOptions& options, std::vector<BenchResult>& results) {
+    writeLegacySave(n);
+    Simulation simulation;
+    bool loaded = simulation.loadState(LEGACY_SAVE_PATH);
+    std::remove(LEGACY_SAVE_PATH);
+    if (!loaded) {
+        return;
+    }
+    AutoPilot pilot;
+    results.push_back(measure("autopilot_decide", n, options.minTimeMs, [&]() -> long long {
+        SimInput input = pilot.decide(simulation);
+        benchSink = benchSink + (input.targetX > 0);
+        return 1;
+    }));
+}
+
+#ifdef DODGE_BENCH_SDL
+struct TextBench {
+    SDL_Surface* target = nullptr;
+    SDL_Renderer* renderer = nullptr;
+    TTF_Font* font = nullptr;
+    TextRenderer textRenderer;
+
+    bool init() {
+        if (SDL_Init(0) < 0 || TTF_Init() < 0) {
+            std::cerr << "Failed to initialize SDL/SDL_ttf: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        target = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+        renderer = target ? SDL_CreateSoftwareRenderer(target) : nullptr;
+        if (!renderer) {
+            std::cerr << "Failed to create software renderer: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        font = TTF_OpenFont("assets/arial.ttf", 24);
+        if (!font) {
+            std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
+            return false;
+        }
+        return textRenderer.init(renderer, font);
+    }
+
+    ~TextBench() {
+        textRenderer.release();
+        if (font) TTF_CloseFont(font);
+        if (renderer) SDL_DestroyRenderer(renderer);
+        if (target) SDL_FreeSurface(target);
+        TTF_Quit();
+        SDL_Quit();
+    }
+};
+
+// N is the number of HUD-sized strings drawn per iteration.
+void benchText(TextBench& bench, int n, const BenchOptions& options, std::vector<BenchResult>& results) {
+    SDL_Color color = {255, 255, 255, 255};
+    const char* text = "Score: 12345";
+    results.push_back(measure("render_text", n, options.minTimeMs, [&]() -> long long {
+        for (int i = 0; i < n; ++i) {
+            bench.textRenderer.renderTextAt(text, i % WINDOW_WIDTH, (i * 7) % WINDOW_HEIGHT, color);
+        }
+        return n;
+    }));
+}
+#endif
+
+bool writeCsv(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream outFile(path);
+    if (!outFile) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    outFile << "benchmark,n,items,iterations,total_ms,ns_per_item\n";
+    for (const BenchResult& r : results) {
+        outFile << r.name << "," << r.n << "," << r.items << "," << r.iterations << ","
+                << r.totalMs << "," << r.nsPerItem << "\n";
+    }
+    return true;
+}
+
+bool writeJson(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream outFile(path);
+    if (!outFile) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    outFile << "{\"results\":[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        outFile << "{\"benchmark\":\"" << r.name << "\",\"n\":" << r.n << ",\"items\":" << r.items
+                << ",\"iterations\":" << r.iterations << ",\"total_ms\":" << r.totalMs
+                << ",\"ns_per_item\":" << r.nsPerItem << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    outFile << "]}\n";
+    return true;
+}
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--max-n" && hasValue) {
+            options.maxN = std::atoi(argv[++i]);
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTimeMs = std::atof(argv[++i]);
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--max-n N] [--min-time MS] [--filter NAME] [--csv FILE] [--json FILE]" << std::endl;
+            return 1;
+        }
+    }
+    if (options.maxN < 10 || options.minTimeMs <= 0) {
+        std::cerr << "--max-n must be at least 10 and --min-time positive" << std::endl;
+        return 1;
+    }
+
+    typedef void (*BenchFunction)(int, const BenchOptions&, std::vector<BenchResult>&);
+    struct BenchGroup {
+        const char* name;
+        BenchFunction run;
+    };
+    const BenchGroup groups[] = {
+        {"spawn_object", benchSpawnObject},
+        {"collision", benchCollision},
+        {"obstacle_update", benchObstacleUpdate},
+        {"weather_update", benchWeather},
+        {"savegame", benchSavegame},
+        {"autopilot", benchAutoPilot},
+    };
+    auto selected = [&](const char* name) {
+        return options.filter.empty() || std::string(name).find(options.filter) != std::string::npos;
+    };
+
+    std::vector<BenchResult> results;
+    for (const BenchGroup& group : groups) {
+        if (!selected(group.name)) continue;
+        for (int n = 10; n <= options.maxN; n *= 10) {
+            group.run(n, options, results);
+        }
+    }
+#ifdef DODGE_BENCH_SDL
+    if (selected("render_text")) {
+        TextBench textBench;
+        if (textBench.init()) {
+            for (int n = 10; n <= options.maxN; n *= 10) {
+                benchText(textBench, n, options, results);
+            }
+        }
+    }
+#endif
+
+    std::printf("%-26s %9s %9s %11s %12s\n", "benchmark", "n", "items", "iterations", "ns/item");
+    for (const BenchResult& r : results) {
+        std::printf("%-26s %9d %9lld %11lld %12.3f\n", r.name.c_str(), r.n, r.items, r.iterations, r.nsPerItem);
+    }
+    bool ok = true;
+    if (!options.csvPath.empty()) ok = writeCsv(options.csvPath, results) && ok;
+    if (!options.jsonPath.empty()) ok = writeJson(options.jsonPath, results) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,540 @@
+#include "Simulation.h"
+#include "AllocationCounter.h"
+#include "AutoPilot.h"
+#include "BitStream.h"
+#include "Constants.h"
+#include "GhostNet.h"
+#include "GhostProtocol.h"
+#include "InputLog.h"
+#include "JobSystem.h"
+#include "LinkSimulator.h"
+#include "Percentile.h"
+#include "Random.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct GameResult {
+    long long steps;
+    int score;
+    double elapsedTime;
+    SimStatus status;
+    uint64_t stateHash; // only filled in for the recorded game
+    // Heap allocations made by the pilot and the simulation steps (not the
+    // reset or the input log).
+    uint64_t allocations;
+    bool warmUp; // first game on its Simulation, which may still grow buffers
+};
+
+// The pilot's decision, or a wandering target that moves every second.
+SimInput nextInput(const Simulation& simulation, AutoPilot* pilot, Random& inputRandom, SimInput input,
+                   double& nextRetarget) {
+    if (pilot) {
+        return pilot->decide(simulation);
+    }
+    if (simulation.getElapsedTime() >= nextRetarget) {
+        input.targetX = static_cast<float>(inputRandom.nextInt(WINDOW_WIDTH - PLAYER_WIDTH));
+        input.targetY = static_cast<float>(inputRandom.nextInt(WINDOW_HEIGHT - PLAYER_HEIGHT));
+        nextRetarget = simulation.getElapsedTime() + 1000;
+    }
+    return input;
+}
+
+// Plays one game, driven by the pilot if there is one and otherwise by a
+// wandering target derived from its seed. Either way every game is
+// independent of the others and of the thread that runs it.
+GameResult playGame(Simulation& simulation, AutoPilot* pilot, uint64_t gameSeed, GameMode mode, float dt, double maxTime, InputLog* log) {
+    simulation.seed(gameSeed);
+    simulation.reset(mode);
+    if (pilot) pilot->reset();
+    if (log) log->begin(gameSeed, mode, dt);
+    Random inputRandom(gameSeed, 0);
+    SimInput input = {simulation.getPlayerX(), simulation.getPlayerY(), false};
+    double nextRetarget = 0;
+    GameResult result = {0, 0, 0, SimStatus::RUNNING, 0, 0, false};
+    while (simulation.getStatus() == SimStatus::RUNNING && simulation.getElapsedTime() < maxTime) {
+        uint64_t allocationsBefore = AllocationCounter::getThreadCount();
+        input = nextInput(simulation, pilot, inputRandom, input, nextRetarget);
+        uint64_t pilotAllocations = AllocationCounter::getThreadCount() - allocationsBefore;
+        if (log) log->record(input);
+        allocationsBefore = AllocationCounter::getThreadCount();
+        simulation.step(input, dt);
+        result.allocations += pilotAllocations + AllocationCounter::getThreadCount() - allocationsBefore;
+        ++result.steps;
+    }
+    result.score = simulation.getScore();
+    result.elapsedTime = simulation.getElapsedTime();
+    result.status = simulation.getStatus();
+    if (log) result.stateHash = simulation.getStateHash();
+    return result;
+}
+
+const char* getStatusName(SimStatus status) {
+    switch (status) {
+        case SimStatus::RUNNING: return "running";
+        case SimStatus::COLLIDED: return "collided";
+        case SimStatus::TIME_UP: return "time up";
+        default: return "unknown";
+    }
+}
+
+// Re-simulates a recorded game as fast as possible and prints the outcome.
+int replay(const std::string& path) {
+    InputLog log;
+    if (!log.load(path)) {
+        return 1;
+    }
+    Simulation simulation;
+    auto start = std::chrono::steady_clock::now();
+    simulation.seed(log.getSeed());
+    simulation.reset(log.getMode());
+    int ticks = 0;
+    for (const SimInput& input : log.getInputs()) {
+        if (simulation.getStatus() != SimStatus::RUNNING) break;
+        simulation.step(input, log.getTickMs());
+        ++ticks;
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "seed: " << log.getSeed() << "\n";
+    std::cout << "mode: " << getModeInfo(log.getMode()).name << "\n";
+    std::cout << "ticks: " << ticks << " / " << log.getInputs().size() << "\n";
+    std::cout << "simulated seconds: " << simulation.getElapsedTime() / 1000.0 << "\n";
+    std::cout << "status: " << (log.endedWithSave() ? "saved" : getStatusName(simulation.getStatus())) << "\n";
+    std::cout << "final score: " << simulation.getScore() << "\n";
+    char hash[32];
+    std::snprintf(hash, sizeof(hash), "%016" PRIx64, simulation.getStateHash());
+    std::cout << "state hash: " << hash << "\n";
+    std::cout << "wall ms: " << wallMs << std::endl;
+    return 0;
+}
+
+struct NetConditions {
+    float loss, latency, jitter;
+};
+
+GhostState sampleGhost(GhostSampler& sampler, const Simulation& simulation) {
+    return sampler.sample(static_cast<uint32_t>(simulation.getElapsedTime() / SIM_TICK_MS), simulation.getPlayerX(),
+                          simulation.getPlayerY(), simulation.getTimeSinceFlash(), simulation.getStatus(),
+                          simulation.getScore());
+}
+
+// Feeds a decoder packets nobody's encoder wrote: an absolute snapshot with a
+// score delta (no baseline to add it to), every truncation of a valid packet
+// and random bytes behind a valid header. None may crash it, and the first
+// two must be rejected. Returns false if one was accepted.
+bool checkMalformedPackets(uint64_t seed) {
+    uint8_t packet[GHOST_MAX_PACKET];
+    GhostDecoder decoder;
+    GhostPacketHeader header;
+    GhostState state;
+    bool ok = true;
+
+    BitWriter writer(packet, sizeof(packet));
+    writer.writeBits(0xD6, 8);  // magic
+    writer.writeBool(false);    // snapshot
+    writer.writeBits(1, 8);     // ghost id
+    writer.writeBits(0, 16);    // sequence
+    writer.writeBits(0, 6);     // absolute
+    writer.writeBits(0, 32 + 12 + 12 + 8 + 2);
+    writer.writeBool(true);     // score as a delta
+    writer.writeBits(5, 10);
+    BitReader scoreDelta(packet, writer.getByteCount());
+    if (readGhostHeader(scoreDelta, header) && decoder.decode(scoreDelta, header, state)) {
+        std::cerr << "Accepted a score delta without a baseline" << std::endl;
+        ok = false;
+    }
+
+    GhostEncoder encoder(1);
+    GhostState valid = {1234, 100, 200, 3, 0, 5000};
+    size_t size = encoder.encode(valid, packet, sizeof(packet));
+    for (size_t cut = 0; cut < size; ++cut) {
+        decoder.reset();
+        BitReader truncated(packet, cut);
+        if (readGhostHeader(truncated, header) && decoder.decode(truncated, header, state)) {
+            std::cerr << "Accepted a packet cut to " << cut << " of " << size << " bytes" << std::endl;
+            ok = false;
+        }
+    }
+
+    Random random(seed, 1);
+    for (int i = 0; i < 100000; ++i) {
+        size_t length = 5 + random.nextInt(static_cast<int>(GHOST_MAX_PACKET) - 4);
+        for (size_t b = 5; b < length; ++b) packet[b] = static_cast<uint8_t>(random.next());
+        BitReader noise(packet, length);
+        if (readGhostHeader(noise, header)) {
+            decoder.decode(noise, header, state);
+        }
+    }
+    std::cout << "malformed packets: " << (ok ? "rejected" : "ACCEPTED") << "\n";
+    return ok;
+}
+
+// Streams one game through the ghost protocol without sockets: snapshots go
+// encoder -> link -> decoder and acks come back through a second link, all in
+// simulated time, so a seed repeats the same losses. After the game ends the
+// final state is resent until it arrives. Exits with 3 if it never does or a
+// malformed packet is accepted.
+int ghostTest(uint64_t seed, GameMode mode, float dt, double maxTime, bool bot, const NetConditions& conditions) {
+    const double SEND_INTERVAL = 1000.0 / GHOST_SEND_RATE;
+    const double SETTLE_MS = 10000;
+    Simulation simulation;
+    AutoPilot pilot;
+    simulation.seed(seed);
+    simulation.reset(mode);
+    pilot.reset();
+    Random inputRandom(seed, 0);
+    SimInput input = {simulation.getPlayerX(), simulation.getPlayerY(), false};
+    double nextRetarget = 0;
+    LinkSimulator out(seed), back(seed + 1);
+    out.setConditions(conditions.loss, conditions.latency, conditions.jitter);
+    back.setConditions(conditions.loss, conditions.latency, conditions.jitter);
+    GhostEncoder encoder(1);
+    GhostDecoder decoder;
+    GhostSampler sampler;
+    NetAddress nowhere = {0, 0};
+    uint64_t packets = 0, bytes = 0, acks = 0, undecodable = 0;
+    GhostState received = GhostState();
+    bool anyReceived = false;
+    double now = 0, nextSend = 0, endTime = -1;
+    uint8_t packet[GHOST_MAX_PACKET];
+    LinkSimulator::Packet delivered;
+
+    for (;;) {
+        bool playing = simulation.getStatus() == SimStatus::RUNNING && simulation.getElapsedTime() < maxTime;
+        if (playing) {
+            input = nextInput(simulation, bot ? &pilot : nullptr, inputRandom, input, nextRetarget);
+            simulation.step(input, dt);
+        } else if (endTime < 0) {
+            endTime = now;
+        }
+        now += dt;
+        GhostState state = sampleGhost(sampler, simulation);
+        if (endTime >= 0 && ((anyReceived && received == state) || now - endTime > SETTLE_MS)) {
+            break;
+        }
+        if (now >= nextSend) {
+            nextSend += SEND_INTERVAL;
+            size_t size = encoder.encode(state, packet, sizeof(packet));
+            ++packets;
+            bytes += size;
+            out.submit(nowhere, packet, size, now);
+        }
+        while (out.release(now, delivered)) {
+            BitReader reader(delivered.data, delivered.size);
+            GhostPacketHeader header;
+            GhostState decoded;
+            if (!readGhostHeader(reader, header) || !decoder.decode(reader, header, decoded)) {
+                ++undecodable;
+                continue;
+            }
+            size_t ackSize = writeGhostAck(header.ghostId, header.sequence, packet, sizeof(packet));
+            ++acks;
+            back.submit(nowhere, packet, ackSize, now);
+            if (decoder.getLatestSequence() == header.sequence) {
+                received = decoded;
+                anyReceived = true;
+            }
+        }
+        while (back.release(now, delivered)) {
+            BitReader reader(delivered.data, delivered.size);
+            GhostPacketHeader header;
+            if (readGhostHeader(reader, header) && header.type == GhostPacketType::ACK) {
+                encoder.acknowledge(header.sequence);
+            }
+        }
+    }
+
+    GhostState finalState = sampleGhost(sampler, simulation);
+    double seconds = now / 1000.0;
+    std::cout << "mode: " << getModeInfo(mode).name << "\n";
+    char line[200];
+    std::snprintf(line, sizeof(line), "link: %.1f%% loss, %.0f ms latency, %.0f ms jitter", conditions.loss,
+                  conditions.latency, conditions.jitter);
+    std::cout << line << "\n";
+    std::snprintf(line, sizeof(line), "streamed: %.1f s, %llu snapshots (%.1f/s), %llu lost, %llu absolute, %llu undecodable",
+                  seconds, static_cast<unsigned long long>(packets), packets / seconds,
+                  static_cast<unsigned long long>(out.getDroppedCount()),
+                  static_cast<unsigned long long>(encoder.getAbsoluteCount()),
+                  static_cast<unsigned long long>(undecodable));
+    std::cout << line << "\n";
+    std::snprintf(line, sizeof(line), "acks: %llu sent, %llu lost", static_cast<unsigned long long>(acks),
+                  static_cast<unsigned long long>(back.getDroppedCount()));
+    std::cout << line << "\n";
+    // UDP and IPv4 headers add 28 bytes to every datagram.
+    std::snprintf(line, sizeof(line), "snapshots: %.2f B payload/packet, %.0f B/s payload, %.0f B/s on the wire per ghost",
+                  packets ? static_cast<double>(bytes) / packets : 0.0, bytes / seconds, (bytes + 28.0 * packets) / seconds);
+    std::cout << line << "\n";
+    bool match = anyReceived && received == finalState;
+    std::cout << "final state: " << (match ? "received" : "NOT received") << " (score " << finalState.score
+              << ", tick " << finalState.tick << ")" << std::endl;
+    bool rejected = checkMalformedPackets(seed);
+    return match && rejected ? 0 : 3;
+}
+
+// Plays one game in real time and streams it to a peer (a relay or a game)
+// while listening for other ghosts, then prints what it saw.
+int streamGhost(const NetAddress& peer, uint16_t port, uint64_t seed, GameMode mode, double maxTime, bool bot,
+                const NetConditions& conditions) {
+    GhostNet net;
+    if (!net.open(port, peer)) {
+        return 1;
+    }
+    net.setConditions(conditions.loss, conditions.latency, conditions.jitter);
+    Simulation simulation;
+    AutoPilot pilot;
+    simulation.seed(seed);
+    simulation.reset(mode);
+    pilot.reset();
+    Random inputRandom(seed, 0);
+    SimInput input = {simulation.getPlayerX(), simulation.getPlayerY(), false};
+    double nextRetarget = 0;
+    GhostSampler sampler;
+    std::cout << "streaming ghost " << static_cast<int>(net.getGhostId()) << " to " << formatNetAddress(peer) << std::endl;
+
+    // One more second after the end so the final state gets through.
+    auto tickTime = std::chrono::steady_clock::now();
+    auto tick = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(SIM_TICK_MS));
+    int afterEnd = 0;
+    while (afterEnd < SIM_TICK_RATE) {
+        if (simulation.getStatus() == SimStatus::RUNNING && simulation.getElapsedTime() < maxTime) {
+            input = nextInput(simulation, bot ? &pilot : nullptr, inputRandom, input, nextRetarget);
+            simulation.step(input, SIM_TICK_MS);
+        } else {
+            ++afterEnd;
+        }
+        net.update();
+        net.publish(sampleGhost(sampler, simulation));
+        tickTime += tick;
+        std::this_thread::sleep_until(tickTime);
+    }
+
+    std::cout << "final score: " << simulation.getScore() << "\n";
+    for (int slot = 0; slot < GhostNet::MAX_GHOSTS; ++slot) {
+        const RemoteGhost* ghost = net.getGhost(slot);
+        if (ghost) {
+            std::cout << "ghost " << static_cast<int>(ghost->id) << ": tick " << ghost->state.tick << ", score "
+                      << ghost->state.score << ", " << getStatusName(static_cast<SimStatus>(ghost->state.status)) << "\n";
+        }
+    }
+    net.printStats();
+    return 0;
+}
+}
+
+// Runs many games without a window, audio or fonts and reports throughput,
+// score statistics and the distribution of survival times. Input is a simple
+// wandering target, or the AutoPilot with --bot. With --threads, games are
+// spread over the job system; the results do not depend on the count.
+// With --replay, re-simulates one recorded input log instead.
+// --check-allocations exits with 2 if any game after the first on each thread
+// allocated during its ticks: gameplay is meant to run without touching the
+// heap once the pools and buffers exist.
+// --ghost-test streams one game through the ghost race protocol over a
+// simulated link (--net-loss, --net-latency, --net-jitter) and reports its
+// bandwidth; --ghost-peer plays one in real time against a relay or a game.
+int main(int argc, char* argv[]) {
+    int games = 1000;
+    uint64_t seed = 1;
+    float dt = SIM_TICK_MS;
+    double maxTime = 10 * 60 * 1000.0;
+    std::vector<GameMode> modes = {GameMode::CLASSIC};
+    int threads = 1;
+    bool bot = false;
+    bool checkAllocations = false;
+    std::string replayPath;
+    std::string recordPath;
+    std::string csvPath;
+    bool ghostTestMode = false;
+    std::string ghostPeer;
+    uint16_t ghostPort = 0;
+    NetConditions conditions = {0, 0, 0};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue) {
+            games = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--dt" && hasValue) {
+            dt = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--max-time" && hasValue) {
+            maxTime = std::atof(argv[++i]) * 1000.0;
+        } else if (arg == "--mode" && hasValue) {
+            std::string value = argv[++i];
+            modes.clear();
+            for (int m = 0; m < GAME_MODE_COUNT; ++m) {
+                if (value == "all" || value == getModeInfo(static_cast<GameMode>(m)).name) {
+                    modes.push_back(static_cast<GameMode>(m));
+                }
+            }
+            if (modes.empty()) {
+                modes.push_back(GameMode::CLASSIC);
+            }
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--bot") {
+            bot = true;
+        } else if (arg == "--check-allocations") {
+            checkAllocations = true;
+        } else if (arg == "--csv" && hasValue) {
+            csvPath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = argv[++i];
+        } else if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--ghost-test") {
+            ghostTestMode = true;
+        } else if (arg == "--ghost-peer" && hasValue) {
+            ghostPeer = argv[++i];
+        } else if (arg == "--ghost-port" && hasValue) {
+            ghostPort = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--net-loss" && hasValue) {
+            conditions.loss = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--net-latency" && hasValue) {
+            conditions.latency = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--net-jitter" && hasValue) {
+            conditions.jitter = static_cast<float>(std::atof(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--games N] [--seed S] [--dt MS] [--max-time SECONDS] [--mode classic|survival|all]"
+                      << " [--bot] [--threads N (0 = all cores)] [--csv FILE] [--record FILE] [--check-allocations]"
+                      << " | --replay FILE"
+                      << " | --ghost-test [--net-loss PERCENT] [--net-latency MS] [--net-jitter MS]"
+                      << " | --ghost-peer HOST:PORT [--ghost-port N]" << std::endl;
+            return 1;
+        }
+    }
+    if (!replayPath.empty()) {
+        return replay(replayPath);
+    }
+    if (ghostTestMode) {
+        return ghostTest(seed, modes.front(), dt, maxTime, bot, conditions);
+    }
+    if (!ghostPeer.empty()) {
+        NetAddress peer;
+        if (!parseNetAddress(ghostPeer, peer)) {
+            std::cerr << "Bad --ghost-peer address: " << ghostPeer << std::endl;
+            return 1;
+        }
+        return streamGhost(peer, ghostPort, seed, modes.front(), maxTime, bot, conditions);
+    }
+    if (games <= 0 || dt <= 0 || threads < 0) {
+        std::cerr << "--games and --dt must be positive and --threads not negative" << std::endl;
+        return 1;
+    }
+    std::ofstream csv;
+    if (!csvPath.empty()) {
+        csv.open(csvPath);
+        if (!csv) {
+            std::cerr << "Failed to open " << csvPath << std::endl;
+            return 1;
+        }
+        csv << "mode,seed,seconds,score,status\n";
+    }
+
+    JobSystem jobs(threads);
+    InputLog log;
+    // A few chunks per thread for balance; each chunk reuses one Simulation
+    // since constructing one allocates the full obstacle pool.
+    int gamesPerChunk = std::max(1, games / (jobs.getThreadCount() * 4));
+    std::cout << "threads: " << jobs.getThreadCount() << "\n";
+    std::cout << "input: " << (bot ? "bot" : "wander") << "\n";
+    bool allocationFree = true;
+
+    for (GameMode mode : modes) {
+        std::vector<GameResult> results(games);
+        auto start = std::chrono::steady_clock::now();
+        jobs.parallelFor(games, gamesPerChunk, [&](int, int begin, int end) {
+            Simulation simulation;
+            AutoPilot pilot;
+            for (int game = begin; game < end; ++game) {
+                // Each game gets its own seed so a recorded game replays on its own.
+                // Only the last game (of the last mode) is recorded.
+                bool recordThis = !recordPath.empty() && game == games - 1 && mode == modes.back();
+                results[game] = playGame(simulation, bot ? &pilot : nullptr, seed + game, mode, dt, maxTime, recordThis ? &log : nullptr);
+                results[game].warmUp = game == begin;
+            }
+        });
+        long long totalSteps = 0;
+        long long totalScore = 0;
+        int bestScore = 0;
+        int survived = 0;
+        double simulatedTime = 0;
+        uint64_t warmUpAllocations = 0;
+        uint64_t steadyAllocations = 0;
+        int allocatingGames = 0;
+        std::vector<double> seconds;
+        seconds.reserve(games);
+        for (const GameResult& result : results) {
+            totalSteps += result.steps;
+            totalScore += result.score;
+            bestScore = std::max(bestScore, result.score);
+            if (result.status != SimStatus::COLLIDED) ++survived;
+            simulatedTime += result.elapsedTime;
+            if (result.warmUp) {
+                warmUpAllocations += result.allocations;
+            } else {
+                steadyAllocations += result.allocations;
+                if (result.allocations > 0) ++allocatingGames;
+            }
+            seconds.push_back(result.elapsedTime / 1000.0);
+        }
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (csv.is_open()) {
+            for (int game = 0; game < games; ++game) {
+                const GameResult& result = results[game];
+                csv << getModeInfo(mode).name << "," << seed + game << "," << result.elapsedTime / 1000.0 << ","
+                    << result.score << "," << getStatusName(result.status) << "\n";
+            }
+        }
+        std::sort(seconds.begin(), seconds.end());
+
+        std::cout << "mode: " << getModeInfo(mode).name << "\n";
+        std::cout << "games: " << games << "\n";
+        std::cout << "steps: " << totalSteps << "\n";
+        std::cout << "simulated seconds: " << simulatedTime / 1000.0 << "\n";
+        std::cout << "wall seconds: " << wallSeconds << "\n";
+        std::cout << "games/s: " << (wallSeconds > 0 ? games / wallSeconds : 0) << "\n";
+        std::cout << "average score: " << static_cast<double>(totalScore) / games << "\n";
+        std::cout << "best score: " << bestScore << "\n";
+        // Survival Rush ends at TIME_UP; classic games only at --max-time.
+        std::cout << "not collided: " << survived << " (" << 100.0 * survived / games << "%)\n";
+        char line[160];
+        std::snprintf(line, sizeof(line), "survival seconds: p10 %.1f p25 %.1f p50 %.1f p75 %.1f p90 %.1f max %.1f",
+                      percentile(seconds, 10), percentile(seconds, 25), percentile(seconds, 50),
+                      percentile(seconds, 75), percentile(seconds, 90), seconds.back());
+        std::cout << line << std::endl;
+        if (checkAllocations) {
+            std::cout << "allocations: " << warmUpAllocations << " warming up, " << steadyAllocations
+                      << " in steady state (" << allocatingGames << " games)" << std::endl;
+        }
+        if (steadyAllocations > 0) {
+            allocationFree = false;
+        }
+        if (!recordPath.empty() && mode == modes.back()) {
+            if (!log.save(recordPath)) {
+                return 1;
+            }
+            char hash[32];
+            std::snprintf(hash, sizeof(hash), "%016" PRIx64, results.back().stateHash);
+            std::cout << "last game state hash: " << hash << std::endl;
+        }
+    }
+    if (checkAllocations && !allocationFree) {
+        std::cerr << "Steady-state gameplay allocated on the heap" << std::endl;
+        return 2;
+    }
+    return 0;
+}
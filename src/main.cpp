@@ -1,12 +1,111 @@
 #include "Game.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 
 int main(int argc, char* argv[]) {
     Game game;
+    // Scenario options only take effect with --scenario.
+    bool scenarioMode = false;
+    ScenarioConfig scenario;
+    std::string ghostPeer;
+    uint16_t ghostPort = 0;
+    float netLoss = 0, netLatency = 0, netJitter = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--trace" && hasValue) {
+            game.enableTrace(argv[++i]);
+        } else if (arg == "--record" && hasValue) {
+            game.enableRecording(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            uint64_t seed = std::strtoull(argv[++i], nullptr, 10);
+            game.setSeed(seed);
+            scenario.seed = seed;
+        } else if (arg == "--audio-buffer" && hasValue) {
+            game.setAudioBufferSize(std::atoi(argv[++i]));
+        } else if (arg == "--late-latch") {
+            game.setLateLatch(true);
+        } else if (arg == "--scenario" && hasValue) {
+            std::string value = argv[++i];
+            scenarioMode = true;
+            bool known = false;
+            for (int m = 0; m < GAME_MODE_COUNT; ++m) {
+                if (value == getModeInfo(static_cast<GameMode>(m)).name) {
+                    scenario.mode = static_cast<GameMode>(m);
+                    known = true;
+                }
+            }
+            if (!known) {
+                std::cerr << "Unknown --scenario mode: " << value << std::endl;
+                return 1;
+            }
+        } else if (arg == "--duration" && hasValue) {
+            scenario.seconds = std::atof(argv[++i]);
+        } else if (arg == "--spawn-interval" && hasValue) {
+            scenario.spawnInterval = std::atoi(argv[++i]);
+        } else if (arg == "--object-speed" && hasValue) {
+            scenario.objectSpeed = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--weather" && hasValue) {
+            scenario.weatherForced = true;
+            if (!parseWeatherName(argv[++i], scenario.weather)) {
+                std::cerr << "Unknown --weather: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--rain-rate" && hasValue) {
+            // Drops per second; the ring buffer holds about 10 s of them.
+            scenario.rainDropsPerSecond = static_cast<float>(std::atof(argv[++i]));
+            scenario.rainMaxDrops = std::max(RAIN_MAX_DROPS, static_cast<int>(scenario.rainDropsPerSecond * 10));
+        } else if (arg == "--input" && hasValue) {
+            const char* value = argv[++i];
+            if (std::strcmp(value, "bot") != 0 && std::strcmp(value, "sweep") != 0) {
+                std::cerr << "Unknown --input: " << value << std::endl;
+                return 1;
+            }
+            scenario.input = std::strcmp(value, "sweep") == 0 ? ScenarioInput::SWEEP : ScenarioInput::BOT;
+        } else if (arg == "--no-window") {
+            scenario.noWindow = true;
+        } else if (arg == "--report" && hasValue) {
+            scenario.reportPath = argv[++i];
+        } else if (arg == "--ghost-peer" && hasValue) {
+            ghostPeer = argv[++i];
+        } else if (arg == "--ghost-port" && hasValue) {
+            ghostPort = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--net-loss" && hasValue) {
+            netLoss = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--net-latency" && hasValue) {
+            netLatency = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--net-jitter" && hasValue) {
+            netJitter = static_cast<float>(std::atof(argv[++i]));
+        }
+    }
+    if (scenarioMode) {
+        if (scenario.seconds <= 0) {
+            std::cerr << "--duration must be positive" << std::endl;
+            return 1;
+        }
+        game.setScenario(scenario);
+    }
+    if (!ghostPeer.empty()) {
+        NetAddress peer;
+        if (!parseNetAddress(ghostPeer, peer)) {
+            std::cerr << "Bad --ghost-peer address: " << ghostPeer << std::endl;
+            return 1;
+        }
+        if (!game.enableGhosts(ghostPort, peer)) {
+            return 1;
+        }
+        game.setNetConditions(netLoss, netLatency, netJitter);
+    }
     if (!game.init()) {
         std::cerr << "Initialization failed!" << std::endl;
         return 1;
     }
     game.run();
+    if (scenarioMode && !game.writeScenarioReport()) {
+        return 1;
+    }
     return 0;
 }
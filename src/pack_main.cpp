@@ -0,0 +1,146 @@
+#include "AssetManifest.h"
+#include "Constants.h"
+#include "PackFile.h"
+#include "SaveFile.h"
+#include "TextRenderer.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <SDL_ttf.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Bakes every asset in AssetManifest.h into one pack file: images as RGBA32
+// pixels, sound effects as PCM in the game's mixer format, the font as a glyph
+// atlas plus metrics, and the music as its original bytes (decoded PCM would be
+// tens of megabytes; the game decodes it on a background thread at startup).
+// Run from the directory holding assets/.
+namespace {
+std::vector<uint8_t> surfacePixels(SDL_Surface* surface) {
+    std::vector<uint8_t> pixels(surface->w * surface->h * 4);
+    SDL_LockSurface(surface);
+    for (int row = 0; row < surface->h; ++row) {
+        std::memcpy(&pixels[row * surface->w * 4], static_cast<const uint8_t*>(surface->pixels) + row * surface->pitch,
+                    surface->w * 4);
+    }
+    SDL_UnlockSurface(surface);
+    return pixels;
+}
+
+bool addImage(PackWriter& pack, const AssetInfo& asset) {
+    SDL_Surface* image = IMG_Load(asset.path);
+    if (!image) {
+        std::cerr << "Failed to load " << asset.path << ": " << IMG_GetError() << std::endl;
+        return false;
+    }
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(image);
+    if (!rgba) {
+        std::cerr << "Failed to convert " << asset.path << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> pixels = surfacePixels(rgba);
+    pack.add(asset.name, PackEntryType::TEXTURE, pixels.data(), pixels.size(), rgba->w, rgba->h);
+    SDL_FreeSurface(rgba);
+    return true;
+}
+
+bool addFont(PackWriter& pack, const AssetInfo& asset, int pointSize) {
+    TTF_Font* font = TTF_OpenFont(asset.path, pointSize);
+    if (!font) {
+        std::cerr << "Failed to load " << asset.path << ": " << TTF_GetError() << std::endl;
+        return false;
+    }
+    TextRenderer::GlyphMetrics metrics[TextRenderer::GLYPH_COUNT];
+    SDL_Surface* atlas = TextRenderer::bakeAtlas(font, metrics);
+    TTF_CloseFont(font);
+    if (!atlas) {
+        return false;
+    }
+    SaveWriter data;
+    for (const TextRenderer::GlyphMetrics& glyph : metrics) {
+        data.writeI32(glyph.x);
+        data.writeI32(glyph.y);
+        data.writeI32(glyph.w);
+        data.writeI32(glyph.h);
+        data.writeI32(glyph.advance);
+    }
+    std::vector<uint8_t> pixels = surfacePixels(atlas);
+    data.writeBytes(pixels.data(), pixels.size());
+    pack.add(asset.name, PackEntryType::FONT, data.getBuffer().data(), data.size(),
+             atlas->w, atlas->h, TextRenderer::GLYPH_COUNT);
+    SDL_FreeSurface(atlas);
+    return true;
+}
+
+bool addSound(PackWriter& pack, const AssetInfo& asset) {
+    Mix_Chunk* chunk = Mix_LoadWAV(asset.path);
+    if (!chunk) {
+        std::cerr << "Failed to load " << asset.path << ": " << Mix_GetError() << std::endl;
+        return false;
+    }
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    pack.add(asset.name, PackEntryType::SOUND, chunk->abuf, chunk->alen, frequency, format, channels);
+    Mix_FreeChunk(chunk);
+    return true;
+}
+
+bool addFile(PackWriter& pack, const AssetInfo& asset, PackEntryType type) {
+    std::ifstream inFile(asset.path, std::ios::binary);
+    if (!inFile) {
+        std::cerr << "Failed to open " << asset.path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+    pack.add(asset.name, type, bytes.data(), bytes.size());
+    return true;
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::string outPath = PACK_FILE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--out FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Sound effects are converted by the mixer, so it needs the same output
+    // format as the game, but nothing has to be played.
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    if (SDL_Init(SDL_INIT_AUDIO) < 0 || IMG_Init(IMG_INIT_PNG) != IMG_INIT_PNG || TTF_Init() < 0 ||
+        Mix_OpenAudio(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, AUDIO_CHUNK_SIZE) < 0) {
+        std::cerr << "Failed to initialize SDL: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    PackWriter pack;
+    bool ok = addImage(pack, BACKGROUND_ASSET);
+    for (int i = 0; i < SPRITE_COUNT && ok; ++i) {
+        ok = addImage(pack, SPRITE_ASSETS[i]);
+    }
+    ok = ok && addFont(pack, FONT_ASSET, FONT_SIZE);
+    ok = ok && addSound(pack, HIT_SOUND_ASSET);
+    ok = ok && addFile(pack, MUSIC_ASSET, PackEntryType::MUSIC);
+    ok = ok && pack.write(outPath);
+
+    Mix_CloseAudio();
+    TTF_Quit();
+    IMG_Quit();
+    SDL_Quit();
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Wrote " << outPath << std::endl;
+    return 0;
+}
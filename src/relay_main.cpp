@@ -0,0 +1,168 @@
+#include "BitStream.h"
+#include "GhostProtocol.h"
+#include "LinkSimulator.h"
+#include "UdpSocket.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Local stand-in for a ghost race server. Every player sends its snapshots
+// here; the relay forwards them to every other player it has heard from and
+// routes each ack back to the player that owns the ghost. It never decodes a
+// snapshot, so it works for any number of players up to MAX_PEERS.
+// --loss, --latency and --jitter put its forwarding through a LinkSimulator.
+namespace {
+const int MAX_PEERS = 16;
+const double PEER_TIMEOUT_MS = 5000;
+const double REPORT_INTERVAL_MS = 5000;
+
+struct Peer {
+    bool active;
+    NetAddress address;
+    double lastHeardMs;
+    bool hasGhost;
+    uint8_t ghostId;
+    // Since the last report.
+    uint64_t snapshots, snapshotBytes, acks;
+};
+
+double nowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Peer* findPeer(Peer* peers, const NetAddress& address, double now) {
+    Peer* free = nullptr;
+    for (int i = 0; i < MAX_PEERS; ++i) {
+        if (peers[i].active && peers[i].address == address) {
+            return &peers[i];
+        }
+        if (!peers[i].active && !free) {
+            free = &peers[i];
+        }
+    }
+    if (free) {
+        *free = Peer();
+        free->active = true;
+        free->address = address;
+        free->lastHeardMs = now;
+        std::printf("%s joined\n", formatNetAddress(address).c_str());
+    }
+    return free;
+}
+
+void forward(UdpSocket& socket, LinkSimulator& link, const NetAddress& to, const uint8_t* data, size_t size, double now) {
+    if (link.isPerfect()) {
+        socket.sendTo(to, data, size);
+    } else {
+        link.submit(to, data, size, now);
+    }
+}
+
+void report(Peer* peers, double seconds) {
+    for (int i = 0; i < MAX_PEERS; ++i) {
+        Peer& peer = peers[i];
+        if (!peer.active) continue;
+        if (peer.hasGhost) {
+            std::printf("  ghost %3u from %s: %.1f snapshots/s, %.0f B/s, %.1f B/snapshot, %.1f acks/s\n", peer.ghostId,
+                        formatNetAddress(peer.address).c_str(), peer.snapshots / seconds, peer.snapshotBytes / seconds,
+                        peer.snapshots ? static_cast<double>(peer.snapshotBytes) / peer.snapshots : 0.0,
+                        peer.acks / seconds);
+        } else {
+            std::printf("  %s: no snapshots yet\n", formatNetAddress(peer.address).c_str());
+        }
+        peer.snapshots = 0;
+        peer.snapshotBytes = 0;
+        peer.acks = 0;
+    }
+    std::fflush(stdout);
+}
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = GHOST_DEFAULT_PORT;
+    float loss = 0, latency = 0, jitter = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--port" && hasValue) {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--loss" && hasValue) {
+            loss = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--latency" && hasValue) {
+            latency = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--jitter" && hasValue) {
+            jitter = static_cast<float>(std::atof(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--port N] [--loss PERCENT] [--latency MS] [--jitter MS]" << std::endl;
+            return 1;
+        }
+    }
+
+    UdpSocket socket;
+    if (!socket.open(port)) {
+        return 1;
+    }
+    LinkSimulator link(static_cast<uint64_t>(nowMs()));
+    link.setConditions(loss, latency, jitter);
+    std::printf("Relaying ghosts on port %u (loss %.1f%%, latency %.0f ms, jitter %.0f ms)\n", socket.getLocalPort(),
+                loss, latency, jitter);
+    std::fflush(stdout);
+
+    Peer peers[MAX_PEERS] = {};
+    double lastReport = nowMs();
+    uint8_t packet[GHOST_MAX_PACKET];
+    for (;;) {
+        double now = nowMs();
+        NetAddress from;
+        int size;
+        while ((size = socket.receiveFrom(from, packet, sizeof(packet))) > 0) {
+            BitReader reader(packet, static_cast<size_t>(size));
+            GhostPacketHeader header;
+            if (!readGhostHeader(reader, header)) {
+                continue;
+            }
+            Peer* sender = findPeer(peers, from, now);
+            if (!sender) {
+                continue;
+            }
+            sender->lastHeardMs = now;
+            if (header.type == GhostPacketType::SNAPSHOT) {
+                sender->hasGhost = true;
+                sender->ghostId = header.ghostId;
+                ++sender->snapshots;
+                sender->snapshotBytes += size;
+                for (int i = 0; i < MAX_PEERS; ++i) {
+                    if (peers[i].active && &peers[i] != sender) {
+                        forward(socket, link, peers[i].address, packet, size, now);
+                    }
+                }
+            } else {
+                ++sender->acks;
+                for (int i = 0; i < MAX_PEERS; ++i) {
+                    if (peers[i].active && peers[i].hasGhost && peers[i].ghostId == header.ghostId) {
+                        forward(socket, link, peers[i].address, packet, size, now);
+                    }
+                }
+            }
+        }
+        LinkSimulator::Packet delayed;
+        while (link.release(now, delayed)) {
+            socket.sendTo(delayed.to, delayed.data, delayed.size);
+        }
+        for (int i = 0; i < MAX_PEERS; ++i) {
+            if (peers[i].active && now - peers[i].lastHeardMs > PEER_TIMEOUT_MS) {
+                std::printf("%s left\n", formatNetAddress(peers[i].address).c_str());
+                peers[i].active = false;
+            }
+        }
+        if (now - lastReport >= REPORT_INTERVAL_MS) {
+            report(peers, (now - lastReport) / 1000.0);
+            lastReport = now;
+        }
+        // A millisecond of added latency at most; the relay is idle otherwise.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}